@@ -5,28 +5,28 @@
 
 void CollisionHash::AddToCollision(UActor* actor)
 {
-	if (actor->bCollideActors())
+	vec3 location = actor->Location();
+	float height = actor->CollisionHeight();
+	float radius = actor->CollisionRadius();
+	vec3 extents = { radius, radius, height };
+
+	actor->CollisionHashInfo.Inserted = true;
+	actor->CollisionHashInfo.Colliding = actor->bCollideActors();
+	actor->CollisionHashInfo.Location = location;
+	actor->CollisionHashInfo.Height = height;
+	actor->CollisionHashInfo.Radius = radius;
+	MaxRadiusOverHeight = std::max(MaxRadiusOverHeight, radius - height);
+
+	auto& buckets = actor->CollisionHashInfo.Colliding ? CollisionActors : NonCollidingActors;
+	ivec3 start = GetStartExtents(location, extents);
+	ivec3 end = GetEndExtents(location, extents);
+	for (int z = start.z; z < end.z; z++)
 	{
-		vec3 location = actor->Location();
-		float height = actor->CollisionHeight();
-		float radius = actor->CollisionRadius();
-		vec3 extents = { radius, radius, height };
-
-		actor->CollisionHashInfo.Inserted = true;
-		actor->CollisionHashInfo.Location = location;
-		actor->CollisionHashInfo.Height = height;
-		actor->CollisionHashInfo.Radius = radius;
-
-		ivec3 start = GetStartExtents(location, extents);
-		ivec3 end = GetEndExtents(location, extents);
-		for (int z = start.z; z < end.z; z++)
+		for (int y = start.y; y < end.y; y++)
 		{
-			for (int y = start.y; y < end.y; y++)
+			for (int x = start.x; x < end.x; x++)
 			{
-				for (int x = start.x; x < end.x; x++)
-				{
-					CollisionActors[GetBucketId(x, y, z)].push_back(actor);
-				}
+				buckets[GetBucketId(x, y, z)].push_back(actor);
 			}
 		}
 	}
@@ -41,6 +41,7 @@ void CollisionHash::RemoveFromCollision(UActor* actor)
 		float radius = actor->CollisionHashInfo.Radius;
 		vec3 extents = { radius, radius, height };
 
+		auto& buckets = actor->CollisionHashInfo.Colliding ? CollisionActors : NonCollidingActors;
 		ivec3 start = GetStartExtents(location, extents);
 		ivec3 end = GetEndExtents(location, extents);
 		for (int z = start.z; z < end.z; z++)
@@ -49,12 +50,12 @@ void CollisionHash::RemoveFromCollision(UActor* actor)
 			{
 				for (int x = start.x; x < end.x; x++)
 				{
-					auto it = CollisionActors.find(GetBucketId(x, y, z));
-					if (it != CollisionActors.end())
+					auto it = buckets.find(GetBucketId(x, y, z));
+					if (it != buckets.end())
 					{
 						it->second.remove(actor);
 						if (it->second.empty())
-							CollisionActors.erase(it);
+							buckets.erase(it);
 					}
 				}
 			}
@@ -181,3 +182,39 @@ std::vector<UActor*> CollisionHash::CollidingActors(const vec3& origin, float ra
 
 	return uniqueHits;
 }
+
+bool CollisionHash::NearbyActors(const vec3& origin, float radius, std::vector<UActor*>& actors)
+{
+	// An actor within radius + CollisionRadius always overlaps these buckets horizontally.
+	// Vertically it only spans CollisionHeight, so pad by the largest radius/height difference.
+	vec3 extents = { radius, radius, radius + MaxRadiusOverHeight };
+
+	ivec3 start = GetStartExtents(origin, extents);
+	ivec3 end = GetEndExtents(origin, extents);
+	if (end.x - start.x >= 100 || end.y - start.y >= 100 || end.z - start.z >= 100)
+		return false;
+
+	std::set<UActor*> seenActors;
+	for (auto* buckets : { &CollisionActors, &NonCollidingActors })
+	{
+		for (int z = start.z; z < end.z; z++)
+		{
+			for (int y = start.y; y < end.y; y++)
+			{
+				for (int x = start.x; x < end.x; x++)
+				{
+					auto it = buckets->find(GetBucketId(x, y, z));
+					if (it != buckets->end())
+					{
+						for (UActor* actor : it->second)
+						{
+							if (seenActors.insert(actor).second)
+								actors.push_back(actor);
+						}
+					}
+				}
+			}
+		}
+	}
+	return true;
+}
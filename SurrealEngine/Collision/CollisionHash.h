@@ -11,11 +11,18 @@ class CollisionHash
 public:
 	std::unordered_map<uint32_t, std::list<UActor*>> CollisionActors;
 
+	// Actors without bCollideActors, bucketed the same way. Only the radius iterators look at these.
+	std::unordered_map<uint32_t, std::list<UActor*>> NonCollidingActors;
+
 	void AddToCollision(UActor* actor);
 	void RemoveFromCollision(UActor* actor);
 
 	std::vector<UActor*> CollidingActors(const vec3& origin, float radius);
 
+	// Candidates for actors within radius + CollisionRadius of origin, including the non-colliding ones.
+	// Returns false if the radius covers too many buckets and the caller should walk the actor lists instead.
+	bool NearbyActors(const vec3& origin, float radius, std::vector<UActor*>& actors);
+
 	static ivec3 GetStartExtents(const vec3& location, const vec3& extents)
 	{
 		int xx = (int)std::floor((location.x - extents.x) * (1.0f / 256.0f));
@@ -85,4 +92,8 @@ public:
 	double ActorRayIntersect(const dvec3& origin, double tmin, const dvec3& dirNormalized, double tmax, UActor* actor);
 	double ActorSphereIntersect(const dvec3& origin, double tmin, const dvec3& dirNormalized, double tmax, double sphereRadius, UActor* actor);
 	double RaySphereIntersect(const dvec3& rayOrigin, double tmin, const dvec3& rayDirNormalized, double tmax, const dvec3& sphereCenter, double sphereRadius);
+
+private:
+	// Largest CollisionRadius - CollisionHeight inserted so far. NearbyActors pads its vertical extents with it.
+	float MaxRadiusOverHeight = 0.0f;
 };
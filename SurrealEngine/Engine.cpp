@@ -23,6 +23,7 @@
 #include "VM/Frame.h"
 #include "VM/NativeFuncExtractor.h"
 #include "VM/ScriptCall.h"
+#include "VM/ScriptProfiler.h"
 #include "UI/Debugger/DebuggerWindow.h"
 #include <chrono>
 #include <set>
@@ -33,7 +34,7 @@ Engine::Engine(GameLaunchInfo launchinfo) : LaunchInfo(launchinfo)
 {
 	engine = this;
 
-	packages = std::make_unique<PackageManager>(LaunchInfo.folder, LaunchInfo.engineVersion, LaunchInfo.gameName);
+	packages = std::make_unique<PackageManager>(LaunchInfo.folder, LaunchInfo.engineVersion, LaunchInfo.gameName, LaunchInfo.scriptCache);
 
 	// Frame::AddBreakpoint("Botpack", "DeathMatchPlus", "Timer");
 }
@@ -285,6 +286,7 @@ void Engine::LoadMap(const UnrealURL& url, const std::map<std::string, std::stri
 		if (actor)
 		{
 			actor->XLevel() = Level;
+			Level->AddToActorIndex(actor);
 			Level->Hash.AddToCollision(actor);
 		}
 	}
@@ -310,6 +312,7 @@ void Engine::LoadMap(const UnrealURL& url, const std::map<std::string, std::stri
 	GameInfo->InitActorZone();
 
 	Level->Actors.push_back(GameInfo);
+	Level->AddToActorIndex(GameInfo);
 
 	// Note: this is never true. But maybe it will be once map loading or level hubs are implemented? If not, delete it!
 	if (LevelInfo->bBegunPlay())
@@ -339,7 +342,7 @@ void Engine::LoadMap(const UnrealURL& url, const std::map<std::string, std::stri
 			for (USpawnNotify* notifyObj = LevelInfo->SpawnNotify(); notifyObj != nullptr; notifyObj = notifyObj->Next())
 			{
 				UClass* cls = notifyObj->ActorClass();
-				if (cls && GameInfo->IsA(cls->Name))
+				if (cls && GameInfo->IsA(cls))
 					GameInfo = UObject::Cast<UGameInfo>(CallEvent(notifyObj, "SpawnNotification", { ExpressionValue::ObjectValue(GameInfo) }).ToObject());
 			}
 		}
@@ -515,6 +518,49 @@ std::string Engine::ConsoleCommand(UObject* context, const std::string& commandl
 	{
 		Frame::ShowDebuggerWindow();
 	}
+	else if (command == "scriptprofile" && args.size() >= 2)
+	{
+		std::string action = args[1];
+		for (char& c : action) c = std::tolower(c);
+
+		if (action == "start")
+		{
+			ScriptProfiler::Start();
+		}
+		else if (action == "stop")
+		{
+			ScriptProfiler::Stop();
+		}
+		else if (action == "reset")
+		{
+			ScriptProfiler::Reset();
+		}
+		else if (action == "report" && args.size() == 3)
+		{
+			ScriptProfiler::WriteReport(args[2]);
+		}
+		else if (action == "report")
+		{
+			std::string report = ScriptProfiler::Report();
+			size_t pos = 0;
+			while (pos < report.size())
+			{
+				size_t end = report.find('\n', pos);
+				if (end == std::string::npos)
+					end = report.size();
+				LogMessage(report.substr(pos, end - pos));
+				pos = end + 1;
+			}
+		}
+		else if (action == "trace" && args.size() == 3)
+		{
+			ScriptProfiler::WriteChromeTrace(args[2]);
+		}
+		else
+		{
+			LogMessage("Usage: scriptprofile start|stop|reset|report [filename]|trace <filename>");
+		}
+	}
 	/*else if (command == "playsong")
 	{
 		auto music = LevelInfo->Song();
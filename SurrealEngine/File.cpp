@@ -216,6 +216,21 @@ std::string File::read_all_text(const std::string& filename)
 	return buffer;
 }
 
+int64_t File::get_last_write_time(const std::string& filename)
+{
+#ifdef WIN32
+	WIN32_FILE_ATTRIBUTE_DATA data = {};
+	if (!GetFileAttributesEx(to_utf16(filename).c_str(), GetFileExInfoStandard, &data))
+		return 0;
+	return ((int64_t)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+#else
+	struct stat statbuf;
+	if (stat(filename.c_str(), &statbuf) == -1)
+		return 0;
+	return (int64_t)statbuf.st_mtime;
+#endif
+}
+
 /////////////////////////////////////////////////////////////////////////////
 
 #ifdef WIN32
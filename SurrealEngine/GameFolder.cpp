@@ -36,6 +36,7 @@ GameLaunchInfo GameFolderSelection::GetLaunchInfo()
 	info.gameName = commandline->GetArg("-g", "--game", info.gameName);
 	info.noEntryMap = commandline->HasArg("-n", "--noentrymap") || info.noEntryMap;
 	info.url = commandline->GetArg("-u", "--url", info.url);
+	info.scriptCache = commandline->GetArg("-sc", "--script-cache", info.scriptCache);
 
 	return info;
 }
@@ -7,6 +7,7 @@ struct GameLaunchInfo
 	std::string gameName;
 	bool noEntryMap = false;
 	std::string url;
+	std::string scriptCache;
 };
 
 struct GameFolder
@@ -5,7 +5,9 @@
 #include "GameFolder.h"
 #include "Package/PackageManager.h"
 #include "UObject/NativeObjExtractor.h"
+#include "VM/CompiledScript.h"
 #include "VM/NativeFuncExtractor.h"
+#include "VM/ScriptTranslator.h"
 #include "UTF16.h"
 #include "File.h"
 #include <iostream>
@@ -22,6 +24,9 @@ void appMain(std::vector<std::string> args)
 	GameLaunchInfo info = GameFolderSelection::GetLaunchInfo();
 	if (!info.folder.empty())
 	{
+		// The translator writes the bytecode hash of every function, so it must be computed as the code gets decoded
+		CompiledScript::Translating = commandline->HasArg("-ts", "--translate-script");
+
 		Engine engine(info);
 		if (commandline->HasArg("-ef", "--extract-nativefunc"))
 		{
@@ -31,6 +36,11 @@ void appMain(std::vector<std::string> args)
 		{
 			File::write_all_text("nativeobjs.txt", NativeObjExtractor::Run(engine.packages.get()));
 		}
+		else if (commandline->HasArg("-ts", "--translate-script"))
+		{
+			// Add the generated file to SurrealEngine/CompiledScript to build it into the engine
+			File::write_all_text("compiledscript.cpp", ScriptTranslator::Run(engine.packages.get(), commandline->GetArg("-ts", "--translate-script")));
+		}
 		else
 		{
 			engine.Run();
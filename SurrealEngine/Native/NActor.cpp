@@ -102,12 +102,12 @@ void NActor::AutonomousPhysics(UObject* Self, float DeltaSeconds)
 
 void NActor::BasedActors(UObject* Self, UObject* BaseClass, UObject*& Actor)
 {
-	Frame::CreatedIterator = std::make_unique<BasedActorsIterator>(BaseClass, &Actor);
+	Frame::CreatedIterator = std::make_unique<BasedActorsIterator>(UObject::Cast<UActor>(Self), BaseClass, &Actor);
 }
 
 void NActor::ChildActors(UObject* Self, UObject* BaseClass, UObject*& Actor)
 {
-	Frame::CreatedIterator = std::make_unique<ChildActorsIterator>(BaseClass, &Actor);
+	Frame::CreatedIterator = std::make_unique<ChildActorsIterator>(UObject::Cast<UActor>(Self), BaseClass, &Actor);
 }
 
 void NActor::ConsoleCommand(UObject* Self, const std::string& Command, std::string& ReturnValue)
@@ -157,8 +157,7 @@ void NActor::FinishAnim(UObject* Self)
 void NActor::FinishInterpolation(UObject* Self)
 {
 	engine->LogUnimplemented("FinishInterpolation");
-	if (Self->StateFrame)
-		Self->StateFrame->LatentState = LatentRunState::FinishInterpolation;
+	UObject::Cast<UActor>(Self)->SuspendStateCode(LatentRunState::FinishInterpolation);
 }
 
 void NActor::GetAnimGroup(UObject* Self, const NameString& Sequence, NameString& ReturnValue)
@@ -241,7 +240,7 @@ void NActor::GetNextSkin(UObject* Self, const std::string& Prefix, const std::st
 	// Filter list to only those with the matching skin prefix
 	for (const IntObject& skin : engine->packages->GetIntObjects("Texture"))
 	{
-		if (skin.Name.Value.size() >= prefix.size() && skin.Name.Value.substr(0, prefix.size()) == prefix)
+		if (skin.Name.ToString().size() >= prefix.size() && skin.Name.ToString().substr(0, prefix.size()) == prefix)
 			skins.push_back(&skin);
 	}
 
@@ -435,14 +434,16 @@ void NActor::SetTimer(UObject* Self, float NewTimerRate, bool bLoop)
 	SelfActor->TimerCounter() = 0.0f;
 	SelfActor->TimerRate() = NewTimerRate > 0.0f ? NewTimerRate : 0.0f;
 	SelfActor->bTimerLoop() = bLoop;
+	if (SelfActor->XLevel())
+		SelfActor->XLevel()->ScheduleTimer(SelfActor);
 }
 
 void NActor::Sleep(UObject* Self, float Seconds)
 {
 	UActor* SelfActor = UObject::Cast<UActor>(Self);
-	SelfActor->SleepTimeLeft = Seconds;
-	if (Self->StateFrame)
-		Self->StateFrame->LatentState = LatentRunState::Sleep;
+	if (SelfActor->XLevel())
+		SelfActor->XLevel()->ScheduleSleep(SelfActor, Seconds);
+	SelfActor->SuspendStateCode(LatentRunState::Sleep);
 }
 
 void NActor::Spawn(UObject* Self, UObject* SpawnClass, UObject** SpawnOwner, NameString* SpawnTag, vec3* SpawnLocation, Rotator* SpawnRotation, UObject*& ReturnValue)
@@ -462,7 +463,7 @@ void NActor::Subtract_ColorColor(const Color& A, const Color& B, Color& ReturnVa
 
 void NActor::TouchingActors(UObject* Self, UObject* BaseClass, UObject*& Actor)
 {
-	Frame::CreatedIterator = std::make_unique<TouchingActorsIterator>(BaseClass, &Actor);
+	Frame::CreatedIterator = std::make_unique<TouchingActorsIterator>(UObject::Cast<UActor>(Self), BaseClass, &Actor);
 }
 
 void NActor::Trace(UObject* Self, vec3& HitLocation, vec3& HitNormal, const vec3& TraceEnd, vec3* TraceStart, bool* bTraceActors, vec3* Extent, UObject*& ReturnValue)
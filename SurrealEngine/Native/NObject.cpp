@@ -6,6 +6,8 @@
 #include "Package/PackageManager.h"
 #include "Engine.h"
 #include "Math/quaternion.h"
+#include "UObject/ULevel.h"
+#include "UObject/UActor.h"
 #include <cmath>
 
 #ifdef _MSC_VER
@@ -187,7 +189,72 @@ void NObject::RegisterFunctions()
 		RegisterVMNativeFunc_3("Object", "Left", &NObject::Left, 207);
 		RegisterVMNativeFunc_3("Object", "Right", &NObject::Right, 208);
 		RegisterVMNativeFunc_2("Object", "Caps", &NObject::Caps, 209);
+
+		// No At_StrStr: this layout has no '@' operator and 168 is ComplementEqual_StrStr
+		RegisterVMIntrinsic<&NObject::Concat_StrStr>(228);
+		RegisterVMIntrinsic<&NObject::Len>(204);
+		RegisterVMIntrinsic<&NObject::InStr>(205);
+		RegisterVMIntrinsic<&NObject::Left>(207);
+		RegisterVMIntrinsic<&NObject::Right>(208);
+		RegisterVMIntrinsic<&NObject::Caps>(209);
+	}
+	else
+	{
+		RegisterVMIntrinsic<&NObject::Concat_StrStr>(112);
+		RegisterVMIntrinsic<&NObject::At_StrStr>(168);
+		RegisterVMIntrinsic<&NObject::Len>(125);
+		RegisterVMIntrinsic<&NObject::InStr>(126);
+		RegisterVMIntrinsic<&NObject::Left>(128);
+		RegisterVMIntrinsic<&NObject::Right>(234);
+		RegisterVMIntrinsic<&NObject::Caps>(235);
 	}
+
+	// Operators evaluated inline by native function calls (these native indexes are the same in all supported versions)
+	RegisterVMIntrinsic<&NObject::Not_PreBool>(129);
+	RegisterVMIntrinsic<&NObject::XorXor_BoolBool>(131);
+	RegisterVMIntrinsic<&NObject::Complement_PreInt>(141);
+	RegisterVMIntrinsic<&NObject::Subtract_PreInt>(143);
+	RegisterVMIntrinsic<&NObject::Multiply_IntInt>(144);
+	RegisterVMIntrinsic<&NObject::Divide_IntInt>(145);
+	RegisterVMIntrinsic<&NObject::Add_IntInt>(146);
+	RegisterVMIntrinsic<&NObject::Subtract_IntInt>(147);
+	RegisterVMIntrinsic<&NObject::LessLess_IntInt>(148);
+	RegisterVMIntrinsic<&NObject::GreaterGreater_IntInt>(149);
+	RegisterVMIntrinsic<&NObject::Less_IntInt>(150);
+	RegisterVMIntrinsic<&NObject::Greater_IntInt>(151);
+	RegisterVMIntrinsic<&NObject::LessEqual_IntInt>(152);
+	RegisterVMIntrinsic<&NObject::GreaterEqual_IntInt>(153);
+	RegisterVMIntrinsic<&NObject::EqualEqual_IntInt>(154);
+	RegisterVMIntrinsic<&NObject::NotEqual_IntInt>(155);
+	RegisterVMIntrinsic<&NObject::And_IntInt>(156);
+	RegisterVMIntrinsic<&NObject::Xor_IntInt>(157);
+	RegisterVMIntrinsic<&NObject::Or_IntInt>(158);
+	RegisterVMIntrinsic<&NObject::Subtract_PreFloat>(169);
+	RegisterVMIntrinsic<&NObject::MultiplyMultiply_FloatFloat>(170);
+	RegisterVMIntrinsic<&NObject::Multiply_FloatFloat>(171);
+	RegisterVMIntrinsic<&NObject::Divide_FloatFloat>(172);
+	RegisterVMIntrinsic<&NObject::Percent_FloatFloat>(173);
+	RegisterVMIntrinsic<&NObject::Add_FloatFloat>(174);
+	RegisterVMIntrinsic<&NObject::Subtract_FloatFloat>(175);
+	RegisterVMIntrinsic<&NObject::Less_FloatFloat>(176);
+	RegisterVMIntrinsic<&NObject::Greater_FloatFloat>(177);
+	RegisterVMIntrinsic<&NObject::LessEqual_FloatFloat>(178);
+	RegisterVMIntrinsic<&NObject::GreaterEqual_FloatFloat>(179);
+	RegisterVMIntrinsic<&NObject::EqualEqual_FloatFloat>(180);
+	RegisterVMIntrinsic<&NObject::NotEqual_FloatFloat>(181);
+	RegisterVMIntrinsic<&NObject::Subtract_PreVector>(211);
+	RegisterVMIntrinsic<&NObject::Multiply_VectorFloat>(212);
+	RegisterVMIntrinsic<&NObject::Multiply_FloatVector>(213);
+	RegisterVMIntrinsic<&NObject::Divide_VectorFloat>(214);
+	RegisterVMIntrinsic<&NObject::Add_VectorVector>(215);
+	RegisterVMIntrinsic<&NObject::Subtract_VectorVector>(216);
+	RegisterVMIntrinsic<&NObject::EqualEqual_VectorVector>(217);
+	RegisterVMIntrinsic<&NObject::NotEqual_VectorVector>(218);
+	RegisterVMIntrinsic<&NObject::Dot_VectorVector>(219);
+	RegisterVMIntrinsic<&NObject::Cross_VectorVector>(220);
+	RegisterVMIntrinsic<&NObject::VSize>(225);
+	RegisterVMIntrinsic<&NObject::EqualEqual_BoolBool>(242);
+	RegisterVMIntrinsic<&NObject::NotEqual_BoolBool>(243);
 }
 
 void NObject::Abs(float A, float& ReturnValue)
@@ -282,7 +349,10 @@ void NObject::Asc(const std::string& S, int& ReturnValue)
 
 void NObject::At_StrStr(const std::string& A, const std::string& B, std::string& ReturnValue)
 {
-	ReturnValue = A + " " + B;
+	ReturnValue.reserve(A.size() + 1 + B.size());
+	ReturnValue.assign(A);
+	ReturnValue.push_back(' ');
+	ReturnValue.append(B);
 }
 
 void NObject::Atan(float A, float& ReturnValue)
@@ -292,10 +362,9 @@ void NObject::Atan(float A, float& ReturnValue)
 
 void NObject::Caps(const std::string& S, std::string& ReturnValue)
 {
-	ReturnValue.clear();
-	ReturnValue.reserve(S.size());
-	for (char c : S)
-		ReturnValue.push_back(std::toupper(c));
+	ReturnValue.assign(S);
+	for (char& c : ReturnValue)
+		c = std::toupper(c);
 }
 
 void NObject::Chr(int i, std::string& ReturnValue)
@@ -310,15 +379,9 @@ void NObject::Clamp(int V, int A, int B, int& ReturnValue)
 
 void NObject::ClassIsChildOf(UObject* TestClass, UObject* ParentClass, bool& ReturnValue)
 {
-	for (UClass* cls = UObject::Cast<UClass>(TestClass); cls != nullptr; cls = static_cast<UClass*>(cls->BaseStruct))
-	{
-		if (cls == ParentClass)
-		{
-			ReturnValue = true;
-			return;
-		}
-	}
-	ReturnValue = false;
+	UClass* testClass = UObject::Cast<UClass>(TestClass);
+	UClass* parentClass = UObject::TryCast<UClass>(ParentClass);
+	ReturnValue = testClass && parentClass && testClass->IsChildOf(parentClass);
 }
 
 void NObject::ComplementEqual_FloatFloat(float A, float B, bool& ReturnValue)
@@ -342,7 +405,9 @@ void NObject::Complement_PreInt(int A, int& ReturnValue)
 
 void NObject::Concat_StrStr(const std::string& A, const std::string& B, std::string& ReturnValue)
 {
-	ReturnValue = A + B;
+	ReturnValue.reserve(A.size() + B.size());
+	ReturnValue.assign(A);
+	ReturnValue.append(B);
 }
 
 void NObject::Cos(float A, float& ReturnValue)
@@ -527,6 +592,10 @@ void NObject::GetPropertyText(UObject* Self, const std::string& PropName, std::s
 	{
 		if (prop->Name == PropName)
 		{
+			UActor* actor = UObject::TryCast<UActor>(Self);
+			if (actor && actor->XLevel() && UActor::GetTrackedProperty(prop) == TrackedProperty::TimerCounter)
+				actor->XLevel()->UpdateTimerCounter(actor);
+
 			void* data = Self->PropertyData.Ptr(prop);
 			ReturnValue = prop->PrintValue(data);
 			return;
@@ -628,7 +697,7 @@ void NObject::IsInState(UObject* Self, const NameString& TestState, bool& Return
 
 void NObject::Left(const std::string& S, int i, std::string& ReturnValue)
 {
-	ReturnValue = S.substr(0, clamp(i, 0, (int)S.size()));
+	ReturnValue.assign(S, 0, clamp(i, 0, (int)S.size()));
 }
 
 void NObject::Len(const std::string& S, int& ReturnValue)
@@ -711,7 +780,7 @@ void NObject::Mid(const std::string& S, int i, int* j, std::string& ReturnValue)
 	int end = start + (j ? *j : size);
 	start = clamp(start, 0, size);
 	end = clamp(end, start, size);
-	ReturnValue = S.substr(start, end - start);
+	ReturnValue.assign(S, start, end - start);
 }
 
 void NObject::Min(int A, int B, int& ReturnValue)
@@ -884,7 +953,7 @@ void NObject::ResetConfig()
 void NObject::Right(const std::string& S, int i, std::string& ReturnValue)
 {
 	int count = clamp(i, 0, (int)S.size());
-	ReturnValue = S.substr(S.size() - count);
+	ReturnValue.assign(S, S.size() - count, count);
 }
 
 void NObject::RotRand(bool* bRoll, Rotator& ReturnValue)
@@ -901,7 +970,29 @@ void NObject::SaveConfig(UObject* Self)
 
 void NObject::SetPropertyText(UObject* Self, const std::string& PropName, const std::string& PropValue)
 {
-	throw std::runtime_error("Object.SetPropertyText not implemented");
+	for (UProperty* prop : Self->PropertyData.Class->Properties)
+	{
+		if (prop->Name == PropName)
+		{
+			void* data = Self->PropertyData.Ptr(prop);
+			switch (prop->ValueType)
+			{
+			case ExpressionValueType::ValueByte: *static_cast<uint8_t*>(data) = (uint8_t)std::atoi(PropValue.c_str()); break;
+			case ExpressionValueType::ValueInt: *static_cast<int32_t*>(data) = std::atoi(PropValue.c_str()); break;
+			case ExpressionValueType::ValueFloat: *static_cast<float*>(data) = (float)std::atof(PropValue.c_str()); break;
+			case ExpressionValueType::ValueString: *static_cast<std::string*>(data) = PropValue; break;
+			case ExpressionValueType::ValueName: *static_cast<NameString*>(data) = NameString(PropValue); break;
+			default:
+				engine->LogUnimplemented("Object.SetPropertyText for " + PropName);
+				return;
+			}
+
+			// Same as when script assigns the variable
+			if (UActor* actor = UObject::TryCast<UActor>(Self))
+				actor->TrackedPropertyChanged(UActor::GetTrackedProperty(prop));
+			return;
+		}
+	}
 }
 
 void NObject::Sin(float A, float& ReturnValue)
@@ -0,0 +1,87 @@
+
+#include "Precomp.h"
+#include "NameString.h"
+#include <deque>
+#include <string_view>
+#include <unordered_map>
+
+namespace
+{
+	struct NameHash
+	{
+		size_t operator()(std::string_view str) const
+		{
+			// FNV-1a over the case folded characters
+			size_t hash = 2166136261u;
+			for (char c : str)
+			{
+				uint8_t ch = (uint8_t)c;
+				if (ch >= 'A' && ch <= 'Z')
+					ch = ch - 'A' + 'a';
+				hash = (hash ^ ch) * 16777619u;
+			}
+			return hash;
+		}
+	};
+
+	struct NameEquals
+	{
+		bool operator()(std::string_view a, std::string_view b) const
+		{
+			if (a.size() != b.size())
+				return false;
+			for (size_t i = 0; i < a.size(); i++)
+			{
+				int ca = (uint8_t)a[i];
+				int cb = (uint8_t)b[i];
+				if (ca >= 'A' && ca <= 'Z')
+					ca = ca - 'A' + 'a';
+				if (cb >= 'A' && cb <= 'Z')
+					cb = cb - 'A' + 'a';
+				if (ca != cb)
+					return false;
+			}
+			return true;
+		}
+	};
+
+	// Note: not thread safe. Names are only created on the main thread.
+	struct NamePool
+	{
+		NamePool()
+		{
+			Names.push_back("None");
+			Lookup[Names.back()] = 0;
+		}
+
+		std::deque<std::string> Names; // deque so that the string_view keys stay valid
+		std::unordered_map<std::string_view, uint32_t, NameHash, NameEquals> Lookup;
+	};
+
+	NamePool& GetNamePool()
+	{
+		static NamePool pool;
+		return pool;
+	}
+}
+
+uint32_t NameString::Intern(const char* str, size_t size)
+{
+	if (size == 0)
+		return 0;
+
+	NamePool& pool = GetNamePool();
+	auto it = pool.Lookup.find(std::string_view(str, size));
+	if (it != pool.Lookup.end())
+		return it->second;
+
+	uint32_t index = (uint32_t)pool.Names.size();
+	pool.Names.push_back(std::string(str, size));
+	pool.Lookup[pool.Names.back()] = index;
+	return index;
+}
+
+const std::string& NameString::ToString() const
+{
+	return GetNamePool().Names[Index];
+}
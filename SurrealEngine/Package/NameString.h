@@ -1,26 +1,30 @@
 #pragma once
 
 #include <cstdint>
+#include <cstring>
+#include <algorithm>
 #include <string>
+#include <functional>
 
-//typedef std::string NameString;
-
+// Names are interned into a global pool. Each distinct (case insensitive) name gets an index, making equality and hashing integer operations.
 class NameString
 {
 public:
-	NameString() : Value("None") {}
-	NameString(const char* str) : Value(str) { }
-	NameString(const std::string& value) : Value(!value.empty() ? value : std::string("None")) { }
+	NameString() : Index(0) {}
+	NameString(const char* str) : Index(Intern(str, strlen(str))) { }
+	NameString(const std::string& value) : Index(Intern(value.data(), value.size())) { }
 	NameString(const NameString& other) = default;
 	NameString& operator=(const NameString&) = default;
 
 	int Compare(const NameString& other) const
 	{
-		return Compare(other.Value.data(), other.Value.size());
+		const std::string& otherValue = other.ToString();
+		return Compare(otherValue.data(), otherValue.size());
 	}
 
 	int Compare(const char* other, size_t othersize) const
 	{
+		const std::string& Value = ToString();
 		size_t len = std::min(Value.size(), othersize);
 		for (size_t i = 0; i < len; i++)
 		{
@@ -45,20 +49,33 @@ public:
 			return 0;
 	}
 
-	bool IsNone() const { return *this == NameString(); }
-	const std::string& ToString() const { return Value; }
+	bool IsNone() const { return Index == 0; }
+	const std::string& ToString() const;
+	uint32_t GetIndex() const { return Index; }
+
+	bool operator==(const char* other) const { size_t othersize = strlen(other); return ToString().size() != othersize ? false : Compare(other, othersize) == 0; }
+	bool operator==(const std::string& other) const { return ToString().size() != other.size() ? false : Compare(other.data(), other.size()) == 0; }
+	bool operator!=(const char* other) const { return !(*this == other); }
+	bool operator!=(const std::string& other) const { return !(*this == other); }
 
-	bool operator==(const char* other) const { size_t othersize = strlen(other); return Value.size() != othersize ? false : Compare(other, othersize) == 0; }
-	bool operator==(const std::string& other) const { return Value.size() != other.size() ? false : Compare(other.data(), other.size()) == 0; }
-	bool operator!=(const char* other) const { size_t othersize = strlen(other); return Value.size() != othersize ? true : Compare(other, othersize) != 0; }
-	bool operator!=(const std::string& other) const { return Value.size() != other.size() ? true : Compare(other.data(), other.size()) != 0; }
+	// Note: ordering is by intern index, not alphabetical
+	bool operator==(const NameString& other) const { return Index == other.Index; }
+	bool operator!=(const NameString& other) const { return Index != other.Index; }
+	bool operator<(const NameString& other) const { return Index < other.Index; }
+	bool operator>(const NameString& other) const { return Index > other.Index; }
+	bool operator<=(const NameString& other) const { return Index <= other.Index; }
+	bool operator>=(const NameString& other) const { return Index >= other.Index; }
 
-	bool operator==(const NameString& other) const { return Value.size() != other.Value.size() ? false : Compare(other) == 0; }
-	bool operator!=(const NameString& other) const { return Value.size() != other.Value.size() ? true : Compare(other) != 0; }
-	bool operator<(const NameString& other) const { return Compare(other) < 0; }
-	bool operator>(const NameString& other) const { return Compare(other) > 0; }
-	bool operator<=(const NameString& other) const { return Compare(other) <= 0; }
-	bool operator>=(const NameString& other) const { return Compare(other) >= 0; }
+private:
+	static uint32_t Intern(const char* str, size_t size);
 
-	std::string Value;
+	uint32_t Index;
 };
+
+namespace std
+{
+	template<> struct hash<NameString>
+	{
+		size_t operator()(const NameString& name) const { return name.GetIndex(); }
+	};
+}
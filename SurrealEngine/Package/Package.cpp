@@ -17,11 +17,16 @@
 #include "UObject/UClient.h"
 #include "UObject/UInternetLink.h"
 #include "File.h"
+#include "VM/ScriptCache.h"
 
 Package::Package(PackageManager* packageManager, const NameString& name, const std::string& filename) : Packages(packageManager), Name(name), Filename(filename)
 {
 	ReadTables();
 
+	const std::string& cacheFolder = packageManager->GetScriptCacheFolder();
+	if (!cacheFolder.empty())
+		Scripts = std::make_unique<ScriptCache>(FilePath::combine(cacheFolder, name.ToString() + ".scache"), PackageGuid, File::get_last_write_time(filename));
+
 	bool corePackage = name == "core";
 	bool enginePackage = name == "engine";
 	bool ipdrvPackage = name == "ipdrv";
@@ -160,6 +165,8 @@ Package::Package(PackageManager* packageManager, const NameString& name, const s
 
 Package::~Package()
 {
+	if (Scripts)
+		Scripts->Save();
 }
 
 std::vector<UClass*> Package::GetAllClasses()
@@ -420,8 +427,7 @@ void Package::ReadTables()
 	}
 	else
 	{
-		uint8_t guid[16];
-		stream->ReadBytes(guid, 16);
+		stream->ReadBytes(PackageGuid, 16);
 		uint32_t generationCount = stream->ReadInt32();
 		for (uint32_t i = 0; i < generationCount; i++)
 		{
@@ -3,6 +3,7 @@
 #include "PackageFlags.h"
 #include "ObjectFlags.h"
 #include "NameString.h"
+#include "UObject/NativeTypes.h"
 #include <functional>
 #include <memory>
 #include <map>
@@ -12,6 +13,7 @@ class PackageStream;
 class ObjectStream;
 class UObject;
 class UClass;
+class ScriptCache;
 
 class NameTableEntry
 {
@@ -65,6 +67,8 @@ public:
 
 	std::vector<UClass*> GetAllClasses();
 
+	ScriptCache* GetScriptCache() { return Scripts.get(); }
+
 private:
 	void ReadTables();
 	std::unique_ptr<ObjectStream> OpenObjectStream(int index, const NameString& name, UClass* base);
@@ -75,7 +79,9 @@ private:
 	{
 		NativeClasses[className] = [](const NameString& name, UClass* cls, ObjectFlags flags) -> UObject*
 		{
-			return new T(name, cls, flags);
+			T* obj = new T(name, cls, flags);
+			obj->NativeType = NativeTypes::GetTag<T>();
+			return obj;
 		};
 
 		if (registerInPackage)
@@ -111,6 +117,7 @@ private:
 
 	int Version = 0;
 	PackageFlags Flags = PackageFlags::NoFlags;
+	uint8_t PackageGuid[16] = {};
 	std::vector<NameTableEntry> NameTable;
 	std::vector<ExportTableEntry> ExportTable;
 	std::vector<ImportTableEntry> ImportTable;
@@ -121,6 +128,8 @@ private:
 
 	std::map<NameString, std::function<UObject*(const NameString& name, UClass* cls, ObjectFlags flags)>> NativeClasses;
 
+	std::unique_ptr<ScriptCache> Scripts;
+
 	Package(const Package&) = delete;
 	Package& operator=(const Package&) = delete;
 
@@ -36,7 +36,7 @@
 #include "Native/NScriptedPawn.h"
 #include "Native/NPlayerPawnExt.h"
 
-PackageManager::PackageManager(const std::string& basepath, int engineVersion, const std::string& gameName) : basepath(basepath), engineVersion(engineVersion), gameName(gameName)
+PackageManager::PackageManager(const std::string& basepath, int engineVersion, const std::string& gameName, const std::string& scriptCacheFolder) : basepath(basepath), engineVersion(engineVersion), gameName(gameName), scriptCacheFolder(scriptCacheFolder)
 {
 	NActor::RegisterFunctions();
 	NCanvas::RegisterFunctions();
@@ -195,12 +195,12 @@ UObject* PackageManager::NewObject(const NameString& name, UClass* cls)
 
 UClass* PackageManager::FindClass(const NameString& name)
 {
-	size_t pos = name.Value.find('.');
-	if (pos == 0 || pos == std::string::npos || pos + 1 == name.Value.size())
+	size_t pos = name.ToString().find('.');
+	if (pos == 0 || pos == std::string::npos || pos + 1 == name.ToString().size())
 		return nullptr;
 
-	NameString packageName = name.Value.substr(0, pos);
-	NameString className = name.Value.substr(pos + 1);
+	NameString packageName = name.ToString().substr(0, pos);
+	NameString className = name.ToString().substr(pos + 1);
 
 	try
 	{
@@ -250,9 +250,9 @@ void PackageManager::LoadIntFiles()
 
 					NameString metaClass = obj.MetaClass;
 
-					size_t pos = metaClass.Value.find_last_of('.');
+					size_t pos = metaClass.ToString().find_last_of('.');
 					if (pos != std::string::npos)
-						metaClass = metaClass.Value.substr(pos + 1);
+						metaClass = metaClass.ToString().substr(pos + 1);
 
 					IntObjects[metaClass].push_back(std::move(obj));
 				}
@@ -265,9 +265,9 @@ void PackageManager::LoadIntFiles()
 
 					NameString cls = obj.Class;
 
-					size_t pos = cls.Value.find_last_of('.');
+					size_t pos = cls.ToString().find_last_of('.');
 					if (pos != std::string::npos)
-						cls = cls.Value.substr(pos + 1);
+						cls = cls.ToString().substr(pos + 1);
 
 					IntObjects[cls].push_back(std::move(obj));
 				}
@@ -283,11 +283,11 @@ void PackageManager::LoadIntFiles()
 
 std::vector<IntObject>& PackageManager::GetIntObjects(const NameString& metaclass)
 {
-	size_t pos = metaclass.Value.find_last_of('.');
+	size_t pos = metaclass.ToString().find_last_of('.');
 	if (pos == std::string::npos)
 		return IntObjects[metaclass];
 	else
-		return IntObjects[metaclass.Value.substr(pos + 1)];
+		return IntObjects[metaclass.ToString().substr(pos + 1)];
 }
 
 std::string PackageManager::Localize(NameString packageName, const NameString& sectionName, const NameString& keyName)
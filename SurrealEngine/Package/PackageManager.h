@@ -19,7 +19,7 @@ struct IntObject
 class PackageManager
 {
 public:
-	PackageManager(const std::string& basepath, int engineVersion, const std::string& gameName);
+	PackageManager(const std::string& basepath, int engineVersion, const std::string& gameName, const std::string& scriptCacheFolder = {});
 
 	bool IsUnreal1() const { return engineVersion < 300; }
 	int GetEngineVersion() const { return engineVersion; }
@@ -29,6 +29,8 @@ public:
 
 	std::shared_ptr<PackageStream> GetStream(Package* package);
 
+	const std::string& GetScriptCacheFolder() const { return scriptCacheFolder; }
+
 	UObject* NewObject(const NameString& name, const NameString& package, const NameString& className);
 	UObject* NewObject(const NameString& name, UClass* cls);
 
@@ -73,6 +75,7 @@ private:
 
 	std::string gameName;
 	int engineVersion = 436;
+	std::string scriptCacheFolder;
 
 	friend class Package;
 	friend struct SetDelayLoadActive;
@@ -65,7 +65,7 @@ std::unique_ptr<LightmapTexture> RenderSubsystem::CreateLightmapTexture(const Bs
 
 vec3 RenderSubsystem::FindLightAt(const vec3& location, int zoneIndex)
 {
-	UZoneInfo* zoneActor = dynamic_cast<UZoneInfo*>(engine->Level->Model->Zones[zoneIndex].ZoneActor);
+	UZoneInfo* zoneActor = UObject::TryCast<UZoneInfo>(engine->Level->Model->Zones[zoneIndex].ZoneActor);
 	if (!zoneActor)
 		zoneActor = engine->LevelInfo;
 
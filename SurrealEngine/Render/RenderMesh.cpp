@@ -19,9 +19,9 @@ void RenderSubsystem::DrawMesh(FSceneNode* frame, UActor* actor, bool wireframe)
 	mat4 meshToObject = mesh->RotOrigin.ToMatrix() * mat4::scale(mesh->Scale) * mat4::translate(-mesh->Origin);
 	mat4 meshToWorld = objectToWorld * meshToObject;
 
-	if (dynamic_cast<USkeletalMesh*>(mesh))
+	if (UObject::TryCast<USkeletalMesh>(mesh))
 		DrawSkeletalMesh(frame, actor, static_cast<USkeletalMesh*>(mesh), meshToWorld, color);
-	else if (dynamic_cast<ULodMesh*>(mesh))
+	else if (UObject::TryCast<ULodMesh>(mesh))
 		DrawLodMesh(frame, actor, static_cast<ULodMesh*>(mesh), meshToWorld, color);
 	else
 		DrawMesh(frame, actor, mesh, meshToWorld, color);
@@ -27,7 +27,7 @@ void DisassemblyPage::setFunction(UStruct* func)
 	if (func)
 	{
 		int index = 0;
-		for (Expression* expr : func->Code->Statements)
+		for (Expression* expr : func->GetCode()->Statements)
 		{
 			listview->rootItem()->add(ExpressionItemBuilder::createItem("Statement[" + std::to_string(index) + "]", expr));
 			index++;
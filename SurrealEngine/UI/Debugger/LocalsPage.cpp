@@ -26,7 +26,7 @@ void LocalsPage::setFrame(Frame* frame)
 	{
 		for (UProperty* prop : frame->Func->Properties)
 		{
-			void* ptr = ((uint8_t*)frame->Variables.get()) + prop->DataOffset;
+			void* ptr = ((uint8_t*)frame->Variables) + prop->DataOffset;
 
 			auto item = (TextListViewItem*)listview->rootItem()->add(std::make_unique<TextListViewItem>());
 			item->setText(0, prop->Name.ToString());
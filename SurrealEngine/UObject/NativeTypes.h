@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+
+// Type tags for the native C++ classes, used by UObject::Cast and TryCast.
+// The result of the first dynamic_cast between each pair of native types is remembered, making later casts a table lookup.
+class NativeTypes
+{
+public:
+	enum { MaxTypes = 256 };
+
+	template<typename T>
+	static uint16_t GetTag()
+	{
+		static const uint16_t tag = NextTag < MaxTypes ? NextTag++ : 0;
+		return tag;
+	}
+
+	enum CastResult : uint8_t { Unknown, Fails, Succeeds };
+	static CastResult CastResults[MaxTypes][MaxTypes];
+
+private:
+	static uint16_t NextTag;
+};
@@ -0,0 +1,77 @@
+
+#include "Precomp.h"
+#include "TimerWheel.h"
+#include <cmath>
+
+void TimerWheel::Add(UActor* actor, TimerType type, uint32_t generation, double deadline)
+{
+	TimerEntry entry;
+	entry.Actor = actor;
+	entry.Deadline = deadline;
+	entry.Tick = (uint64_t)std::max(std::ceil(deadline * TicksPerSecond), 0.0);
+	entry.Generation = generation;
+	entry.Type = type;
+	Insert(entry);
+}
+
+void TimerWheel::Insert(const TimerEntry& entry)
+{
+	if (entry.Tick <= Now)
+	{
+		Due.push_back(entry);
+		return;
+	}
+
+	uint64_t delta = entry.Tick - Now;
+	for (int level = 0; level < LevelCount; level++)
+	{
+		if (delta < (uint64_t)1 << (SlotBits * (level + 1)))
+		{
+			Slots[level][(entry.Tick >> (SlotBits * level)) & SlotMask].push_back(entry);
+			return;
+		}
+	}
+	Overflow.push_back(entry);
+}
+
+void TimerWheel::Cascade(int level)
+{
+	std::vector<TimerEntry> entries;
+	if (level == LevelCount)
+		entries.swap(Overflow);
+	else
+		entries.swap(Slots[level][(Now >> (SlotBits * level)) & SlotMask]);
+
+	for (const TimerEntry& entry : entries)
+		Insert(entry);
+}
+
+void TimerWheel::Advance(double time, std::vector<TimerEntry>& expired)
+{
+	Time = std::max(time, Time);
+
+	expired.insert(expired.end(), Due.begin(), Due.end());
+	Due.clear();
+
+	uint64_t target = (uint64_t)std::floor(Time * TicksPerSecond);
+	while (Now < target)
+	{
+		Now++;
+
+		// When a level wraps around, the next slot of the level above is redistributed into the levels below
+		for (int level = 1; level <= LevelCount; level++)
+		{
+			if ((Now & (((uint64_t)1 << (SlotBits * level)) - 1)) != 0)
+				break;
+			Cascade(level);
+		}
+
+		std::vector<TimerEntry>& slot = Slots[0][Now & SlotMask];
+		expired.insert(expired.end(), slot.begin(), slot.end());
+		slot.clear();
+
+		// Cascading may have produced entries for the current tick
+		expired.insert(expired.end(), Due.begin(), Due.end());
+		Due.clear();
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+class UActor;
+
+enum class TimerType : uint8_t
+{
+	Timer,
+	Sleep
+};
+
+struct TimerEntry
+{
+	UActor* Actor = nullptr;
+	double Deadline = 0.0;
+	uint64_t Tick = 0;
+	uint32_t Generation = 0;
+	TimerType Type = TimerType::Timer;
+};
+
+// Hierarchical timing wheel with millisecond ticks.
+// Each level has 256 slots, with every slot of a level spanning all the slots of the level below it.
+// Entries cascade down a level as time reaches their slot, so advancing time only touches slots that expire.
+class TimerWheel
+{
+public:
+	void Add(UActor* actor, TimerType type, uint32_t generation, double deadline);
+
+	// Advances time and appends every entry with a deadline at or before it to expired
+	void Advance(double time, std::vector<TimerEntry>& expired);
+
+	double GetTime() const { return Time; }
+
+private:
+	void Insert(const TimerEntry& entry);
+	void Cascade(int level);
+
+	enum { SlotBits = 8, SlotCount = 1 << SlotBits, SlotMask = SlotCount - 1, LevelCount = 4 };
+	static constexpr double TicksPerSecond = 1000.0;
+
+	double Time = 0.0;
+	uint64_t Now = 0;
+	std::vector<TimerEntry> Slots[LevelCount][SlotCount];
+	std::vector<TimerEntry> Due; // Entries whose tick had already passed when they were added
+	std::vector<TimerEntry> Overflow; // Entries too far away for the top level
+};
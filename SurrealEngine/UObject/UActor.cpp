@@ -41,7 +41,7 @@ UActor* UActor::Spawn(UClass* SpawnClass, UActor* SpawnOwner, NameString SpawnTa
 	actor->Outer() = XLevel()->Outer();
 	actor->XLevel() = XLevel();
 	actor->Level() = Level();
-	actor->Tag() = (!SpawnTag.IsNone()) ? SpawnTag : SpawnClass->Name;
+	actor->Tag() = (!SpawnTag.IsNone()) ? SpawnTag : SpawnClass->Name; // Not indexed yet, so no TrackedPropertyChanged
 	actor->bTicked() = bTicked(); // To do: should it tick in the same world tick it was spawned in or wait until the next one?
 	actor->Instigator() = Instigator();
 	actor->Brush() = nullptr;
@@ -50,6 +50,7 @@ UActor* UActor::Spawn(UClass* SpawnClass, UActor* SpawnOwner, NameString SpawnTa
 	actor->Rotation() = rotation;
 
 	XLevel()->Actors.push_back(actor);
+	XLevel()->AddToActorIndex(actor);
 	XLevel()->Hash.AddToCollision(actor);
 
 	actor->SetOwner(SpawnOwner ? SpawnOwner : this);
@@ -85,7 +86,7 @@ UActor* UActor::Spawn(UClass* SpawnClass, UActor* SpawnOwner, NameString SpawnTa
 				for (USpawnNotify* notifyObj = Level()->SpawnNotify(); notifyObj != nullptr; notifyObj = notifyObj->Next())
 				{
 					UClass* cls = notifyObj->ActorClass();
-					if (cls && actor->IsA(cls->Name))
+					if (cls && actor->IsA(cls))
 						actor = UObject::Cast<UGameInfo>(CallEvent(notifyObj, "SpawnNotification", { ExpressionValue::ObjectValue(actor) }).ToObject());
 				}
 			}
@@ -193,18 +194,13 @@ bool UActor::Destroy()
 
 	SetOwner(nullptr);
 
-	for (size_t i = 0; i < level->Actors.size(); i++)
-	{
-		UActor* actor = level->Actors[i];
-		if (actor && actor->Owner() == this)
-		{
-			actor->SetOwner(nullptr);
-		}
-		if (actor == this)
-		{
-			level->Actors[i] = nullptr;
-		}
-	}
+	while (!OwnedChildren.empty())
+		OwnedChildren.back()->SetOwner(nullptr);
+
+	auto it = std::find(level->Actors.begin(), level->Actors.end(), this);
+	if (it != level->Actors.end())
+		*it = nullptr;
+	level->RemoveFromActorIndex(this);
 
 	return true;
 }
@@ -271,12 +267,23 @@ void UActor::SetOwner(UActor* newOwner)
 	if (Owner())
 		CallEvent(Owner(), "LostChild", { ExpressionValue::ObjectValue(this) });
 
+	if (Owner())
+		RemoveChildActor(Owner()->OwnedChildren, this);
 	Owner() = newOwner;
+	if (Owner())
+		Owner()->OwnedChildren.push_back(this);
 
 	if (Owner())
 		CallEvent(Owner(), "GainedChild", { ExpressionValue::ObjectValue(this) });
 }
 
+void UActor::RemoveChildActor(std::vector<UActor*>& list, UActor* actor)
+{
+	auto it = std::find(list.begin(), list.end(), actor);
+	if (it != list.end())
+		list.erase(it);
+}
+
 void UActor::SetBase(UActor* newBase, bool sendBaseChangeEvent)
 {
 	if (ActorBase() != newBase)
@@ -290,6 +297,7 @@ void UActor::SetBase(UActor* newBase, bool sendBaseChangeEvent)
 		if (ActorBase() && ActorBase() != Level())
 		{
 			ActorBase()->StandingCount()--;
+			RemoveChildActor(ActorBase()->BasedChildren, this);
 			CallEvent(ActorBase(), "Detach", { ExpressionValue::ObjectValue(this) });
 		}
 
@@ -298,6 +306,7 @@ void UActor::SetBase(UActor* newBase, bool sendBaseChangeEvent)
 		if (ActorBase() && ActorBase() != Level())
 		{
 			ActorBase()->StandingCount()++;
+			ActorBase()->BasedChildren.push_back(this);
 			CallEvent(ActorBase(), "Attach", { ExpressionValue::ObjectValue(this) });
 		}
 
@@ -317,30 +326,95 @@ void UActor::Tick(float elapsed, bool tickedFlag)
 		CallEvent(this, tickEventName, { ExpressionValue::FloatValue(elapsed) });
 	}
 
-	if (StateFrame && StateFrame->LatentState == LatentRunState::Sleep)
-	{
-		SleepTimeLeft = std::max(SleepTimeLeft - elapsed, 0.0f);
-		if (SleepTimeLeft == 0.0f)
-			StateFrame->LatentState = LatentRunState::Continue;
-	}
+	TickPhysics(elapsed);
+
+	// Timer and Sleep deadlines are dispatched by ULevel::Tick, as is the state code when it resumes
+}
 
-	if (Role() >= ROLE_SimulatedProxy && StateFrame && StateFrame->LatentState == LatentRunState::Continue)
+bool UActor::NeedsTick()
+{
+	if (Physics() != PHYS_None || IsAnimating() || AnimFrame() < 0.0f || LifeSpan() != 0.0f || PendingTouch())
+		return true;
+
+	// Which Tick event applies only changes with the class or state
+	UStruct* state = StateFrame ? StateFrame->Func : nullptr;
+	if (TickEventClass != Class || TickEventState != state)
 	{
-		StateFrame->Tick();
+		static const NameString tickName = "Tick";
+		TickEventClass = Class;
+		TickEventState = state;
+		HasTickEvent = FindEventFunction(this, tickName) != nullptr;
 	}
+	return HasTickEvent;
+}
 
-	TickPhysics(elapsed);
+void UActor::WakeUp()
+{
+	if (Dormant && XLevel())
+		XLevel()->WakeActor(this);
+}
 
-	if (TimerRate() > 0.0f) // Role() == ROLE_Authority && RemoteRole() == ROLE_AutonomousProxy
+TrackedProperty UActor::GetTrackedProperty(UProperty* prop)
+{
+	// The offset check leaves variables of other classes that happen to share the name alone
+	const NameString& name = prop->Name;
+	size_t offset = prop->DataOffset;
+	if (name == "Tag" && offset == PropOffsets_Actor.Tag && prop->ValueType == ExpressionValueType::ValueName)
+		return TrackedProperty::Tag;
+	if ((name == "LifeSpan" && offset == PropOffsets_Actor.LifeSpan) ||
+		(name == "AnimRate" && offset == PropOffsets_Actor.AnimRate) ||
+		(name == "AnimFrame" && offset == PropOffsets_Actor.AnimFrame) ||
+		(name == "PendingTouch" && offset == PropOffsets_Actor.PendingTouch))
+		return TrackedProperty::Tick;
+	if (name == "TimerRate" && offset == PropOffsets_Actor.TimerRate)
+		return TrackedProperty::TimerRate;
+	if (name == "TimerCounter" && offset == PropOffsets_Actor.TimerCounter)
+		return TrackedProperty::TimerCounter;
+	return TrackedProperty::None;
+}
+
+void UActor::TrackedPropertyChanged(TrackedProperty property)
+{
+	switch (property)
 	{
-		TimerCounter() += elapsed;
-		while (TimerRate() > 0.0f && TimerCounter() > TimerRate())
+	case TrackedProperty::None: break;
+	case TrackedProperty::Tag: if (XLevel()) XLevel()->TagsModified = true; break;
+	case TrackedProperty::Tick: WakeUp(); break; // NeedsTick may say otherwise now
+	case TrackedProperty::TimerRate:
+	case TrackedProperty::TimerCounter:
+		if (XLevel())
 		{
-			TimerCounter() -= TimerRate();
-			if (!bTimerLoop())
-				TimerRate() = 0.0f;
-			CallEvent(this, "Timer");
+			// A new rate keeps the time already counted, a new counter value replaces it
+			if (property == TrackedProperty::TimerRate)
+				XLevel()->UpdateTimerCounter(this);
+			XLevel()->ScheduleTimer(this);
 		}
+		break;
+	}
+}
+
+void UActor::GotoState(NameString stateName, const NameString& labelName)
+{
+	UObject::GotoState(stateName, labelName);
+	WakeUp();
+
+	if (StateFrame && StateFrame->LatentState == LatentRunState::Continue && XLevel())
+		XLevel()->ScheduleStateCode(this);
+}
+
+void UActor::SuspendStateCode(LatentRunState condition)
+{
+	if (StateFrame)
+		StateFrame->LatentState = condition;
+}
+
+void UActor::ResumeStateCode(LatentRunState condition)
+{
+	if (StateFrame && StateFrame->LatentState == condition)
+	{
+		StateFrame->LatentState = LatentRunState::Continue;
+		if (XLevel())
+			XLevel()->ScheduleStateCode(this);
 	}
 }
 
@@ -705,7 +779,7 @@ void UActor::TickInterpolating(float elapsed)
 
 		float physAlpha = PhysAlpha();
 
-		if (dynamic_cast<UPlayerPawn*>(this))
+		if (UObject::TryCast<UPlayerPawn>(this))
 		{
 			UPlayerPawn* pawn = static_cast<UPlayerPawn*>(this);
 			pawn->DesiredFlashScale() = mix(target->ScreenFlashScale(), next->ScreenFlashScale(), physAlpha);
@@ -753,7 +827,7 @@ void UActor::TickInterpolating(float elapsed)
 		TryMove(location - Location());
 		Rotation() = rotation;
 
-		if (dynamic_cast<UPawn*>(this))
+		if (UObject::TryCast<UPawn>(this))
 		{
 			static_cast<UPawn*>(this)->ViewRotation() = Rotation();
 		}
@@ -762,6 +836,7 @@ void UActor::TickInterpolating(float elapsed)
 		{
 			CallEvent(target, "InterpolateEnd", { ExpressionValue::ObjectValue(this) });
 			CallEvent(this, "InterpolateEnd", { ExpressionValue::ObjectValue(target) });
+			ResumeStateCode(LatentRunState::FinishInterpolation);
 
 			target = target->Prev();
 			while (target && target->bSkipNextPath())
@@ -774,6 +849,7 @@ void UActor::TickInterpolating(float elapsed)
 		{
 			CallEvent(target, "InterpolateEnd", { ExpressionValue::ObjectValue(this) });
 			CallEvent(this, "InterpolateEnd", { ExpressionValue::ObjectValue(target) });
+			ResumeStateCode(LatentRunState::FinishInterpolation);
 
 			target = target->Next();
 			while (target && target->bSkipNextPath())
@@ -843,6 +919,7 @@ void UActor::TickMovingBrush(float elapsed)
 				{
 					bInterpolating() = false;
 					CallEvent(this, "InterpolateEnd", { ExpressionValue::ObjectValue(nullptr) });
+					ResumeStateCode(LatentRunState::FinishInterpolation);
 				}
 			}
 		}
@@ -862,7 +939,12 @@ void UActor::TickTrailer(float elapsed)
 
 void UActor::SetPhysics(uint8_t newPhysics)
 {
+	uint8_t oldPhysics = Physics();
 	Physics() = newPhysics;
+	WakeUp();
+
+	if (oldPhysics == PHYS_Falling && newPhysics != PHYS_Falling)
+		ResumeStateCode(LatentRunState::WaitForLanding);
 }
 
 void UActor::SetCollision(bool newColActors, bool newBlockActors, bool newBlockPlayers)
@@ -1017,13 +1099,12 @@ SweepHit UActor::TryMove(const vec3& delta)
 	XLevel()->Hash.AddToCollision(this);
 
 	// Based actors needs to move with us
-	if (StandingCount() > 0)
+	if (!BasedChildren.empty())
 	{
-		ULevel* level = XLevel();
-		for (size_t i = 0; i < level->Actors.size(); i++)
+		std::vector<UActor*> basedActors = BasedChildren;
+		for (UActor* actor : basedActors)
 		{
-			UActor* actor = level->Actors[i];
-			if (actor && actor->ActorBase() == this)
+			if (actor->ActorBase() == this)
 			{
 				actor->TryMove(actuallyMoved);
 			}
@@ -1179,8 +1260,8 @@ void UActor::FinishAnim()
 		bAnimFinished() = false;
 	}
 
-	if (IsAnimating() && AnimFrame() < AnimLast() && StateFrame)
-		StateFrame->LatentState = LatentRunState::FinishAnim;
+	if (IsAnimating() && AnimFrame() < AnimLast())
+		SuspendStateCode(LatentRunState::FinishAnim);
 }
 
 NameString UActor::GetAnimGroup(const NameString& sequence)
@@ -1217,6 +1298,7 @@ void UActor::PlayAnim(const NameString& sequence, float rate, float tweenTime)
 		MeshAnimSeq* seq = Mesh()->GetSequence(sequence);
 		if (seq)
 		{
+			WakeUp();
 			SetTweenFromAnimFrame();
 
 			AnimSequence() = sequence;
@@ -1256,6 +1338,7 @@ void UActor::LoopAnim(const NameString& sequence, float rate, float tweenTime, f
 		MeshAnimSeq* seq = Mesh()->GetSequence(sequence);
 		if (seq)
 		{
+			WakeUp();
 			if (AnimSequence() == sequence && IsAnimating() && bAnimLoop())
 			{
 				if (seq->NumFrames > 1)
@@ -1307,6 +1390,7 @@ void UActor::TweenAnim(const NameString& sequence, float tweenTime)
 		MeshAnimSeq* seq = Mesh()->GetSequence(sequence);
 		if (seq)
 		{
+			WakeUp();
 			SetTweenFromAnimFrame();
 
 			AnimSequence() = sequence;
@@ -1373,8 +1457,7 @@ void UActor::TickAnimation(float elapsed)
 				elapsed -= (toAnimTime - fromAnimTime) / animRate;
 				AnimFrame() = toAnimTime;
 
-				if (StateFrame && StateFrame->LatentState == LatentRunState::FinishAnim)
-					StateFrame->LatentState = LatentRunState::Continue;
+				ResumeStateCode(LatentRunState::FinishAnim);
 
 				CallEvent(this, "AnimEnd");
 				continue;
@@ -1415,8 +1498,7 @@ void UActor::TickAnimation(float elapsed)
 
 			if (!bAnimLoop() && fromAnimTime < animEndTime && toAnimTime >= animEndTime)
 			{
-				if (StateFrame && StateFrame->LatentState == LatentRunState::FinishAnim)
-					StateFrame->LatentState = LatentRunState::Continue;
+				ResumeStateCode(LatentRunState::FinishAnim);
 
 				CallEvent(this, "AnimEnd");
 			}
@@ -1444,8 +1526,7 @@ void UActor::TickAnimation(float elapsed)
 
 			if (toAnimTime == animEndTime && AnimRate() == 0.0f)
 			{
-				if (StateFrame && StateFrame->LatentState == LatentRunState::FinishAnim)
-					StateFrame->LatentState = LatentRunState::Continue;
+				ResumeStateCode(LatentRunState::FinishAnim);
 
 				bAnimFinished() = true;
 				//engine->LogMessage("CallEvent(AnimEnd) for " + Class->FriendlyName.ToString() + "");
@@ -1537,7 +1618,7 @@ bool UPawn::CanHearNoise(UActor* source, float loudness)
 	UPawn* noisePawn = UObject::Cast<UPawn>(source->Instigator());
 	if (!noisePawn->bIsPlayer() && (!noisePawn->Enemy() || !noisePawn->Enemy()->bIsPlayer()))
 	{
-		if (!IsA(source->Class->Name) && !source->IsA(Class->Name))
+		if (!IsA(source->Class) && !source->IsA(Class))
 			return false;
 	}
 	else if (UObject::TryCast<UPlayerPawn>(this))
@@ -1607,7 +1688,7 @@ void UPawn::Tick(float elapsed, bool tickedFlag)
 		{
 			TickRotateTo(Focus());
 			if (TickMoveTo(Destination()))
-				StateFrame->LatentState = LatentRunState::Continue;
+				ResumeStateCode(StateFrame->LatentState);
 		}
 		else if (StateFrame->LatentState == LatentRunState::MoveToward)
 		{
@@ -1615,18 +1696,18 @@ void UPawn::Tick(float elapsed, bool tickedFlag)
 			{
 				TickRotateTo(Focus());
 				if (TickMoveTo(MoveTarget()->Location()))
-					StateFrame->LatentState = LatentRunState::Continue;
+					ResumeStateCode(StateFrame->LatentState);
 			}
 			else
 			{
-				StateFrame->LatentState = LatentRunState::Continue;
+				ResumeStateCode(StateFrame->LatentState);
 			}
 		}
 		else if (StateFrame->LatentState == LatentRunState::StrafeTo)
 		{
 			TickRotateTo(Focus());
 			if (TickMoveTo(Destination()))
-				StateFrame->LatentState = LatentRunState::Continue;
+				ResumeStateCode(StateFrame->LatentState);
 		}
 		else if (StateFrame->LatentState == LatentRunState::StrafeFacing)
 		{
@@ -1635,40 +1716,29 @@ void UPawn::Tick(float elapsed, bool tickedFlag)
 				TickRotateTo(Focus());
 				vec3 oldDest = Destination();
 				if (TickMoveTo(Destination()))
-					StateFrame->LatentState = LatentRunState::Continue;
+					ResumeStateCode(StateFrame->LatentState);
 				Destination() = oldDest;
 			}
 			else
 			{
-				StateFrame->LatentState = LatentRunState::Continue;
+				ResumeStateCode(StateFrame->LatentState);
 			}
 		}
 		else if (StateFrame->LatentState == LatentRunState::TurnTo)
 		{
 			if (TickRotateTo(Focus()))
-				StateFrame->LatentState = LatentRunState::Continue;
+				ResumeStateCode(StateFrame->LatentState);
 		}
 		else if (StateFrame->LatentState == LatentRunState::TurnToward)
 		{
 			if (FaceTarget())
 			{
 				if (TickRotateTo(FaceTarget()->Location()))
-					StateFrame->LatentState = LatentRunState::Continue;
+					ResumeStateCode(StateFrame->LatentState);
 			}
 			else
 			{
-				StateFrame->LatentState = LatentRunState::Continue;
-			}
-		}
-		else if (StateFrame->LatentState == LatentRunState::WaitForLanding)
-		{
-			if (Physics() != PHYS_Falling)
-			{
-				StateFrame->LatentState = LatentRunState::Continue;
-			}
-			else
-			{
-				// To do: need to send a LongFall event if the fall state lasts long enough
+				ResumeStateCode(StateFrame->LatentState);
 			}
 		}
 	}
@@ -1777,8 +1847,7 @@ void UPawn::MoveTo(const vec3& newDestination, float speed)
 	Destination() = newDestination;
 	Focus() = newDestination;
 	SetMoveDuration(newDestination - Location());
-	if (StateFrame)
-		StateFrame->LatentState = LatentRunState::MoveTo;
+	SuspendStateCode(LatentRunState::MoveTo);
 }
 
 void UPawn::MoveToward(UActor* newTarget, float speed)
@@ -1790,8 +1859,7 @@ void UPawn::MoveToward(UActor* newTarget, float speed)
 	bReducedSpeed() = false;
 	DesiredSpeed() = clamp(speed, 0.0f, MaxDesiredSpeed());
 	SetMoveDuration(newTarget->Location() - Location());
-	if (StateFrame)
-		StateFrame->LatentState = LatentRunState::MoveToward;
+	SuspendStateCode(LatentRunState::MoveToward);
 }
 
 void UPawn::StrafeFacing(const vec3& newDestination, UActor* newTarget)
@@ -1802,8 +1870,7 @@ void UPawn::StrafeFacing(const vec3& newDestination, UActor* newTarget)
 	Destination() = newDestination;
 	FaceTarget() = newTarget;
 	SetMoveDuration(newDestination - Location());
-	if (StateFrame)
-		StateFrame->LatentState = LatentRunState::StrafeFacing;
+	SuspendStateCode(LatentRunState::StrafeFacing);
 }
 
 void UPawn::StrafeTo(const vec3& newDestination, const vec3& newFocus)
@@ -1814,16 +1881,14 @@ void UPawn::StrafeTo(const vec3& newDestination, const vec3& newFocus)
 	Destination() = newDestination;
 	Focus() = newFocus;
 	SetMoveDuration(newDestination - Location());
-	if (StateFrame)
-		StateFrame->LatentState = LatentRunState::StrafeTo;
+	SuspendStateCode(LatentRunState::StrafeTo);
 }
 
 void UPawn::TurnTo(const vec3& newFocus)
 {
 	MoveTarget() = nullptr;
 	Focus() = newFocus;
-	if (StateFrame)
-		StateFrame->LatentState = LatentRunState::TurnTo;
+	SuspendStateCode(LatentRunState::TurnTo);
 }
 
 void UPawn::TurnToward(UActor* newTarget)
@@ -1833,14 +1898,14 @@ void UPawn::TurnToward(UActor* newTarget)
 
 	FaceTarget() = newTarget;
 	Focus() = newTarget->Location();
-	if (StateFrame)
-		StateFrame->LatentState = LatentRunState::TurnToward;
+	SuspendStateCode(LatentRunState::TurnToward);
 }
 
 void UPawn::WaitForLanding()
 {
-	if (Physics() == PHYS_Falling && StateFrame)
-		StateFrame->LatentState = LatentRunState::WaitForLanding;
+	// To do: need to send a LongFall event if the fall state lasts long enough
+	if (Physics() == PHYS_Falling)
+		SuspendStateCode(LatentRunState::WaitForLanding);
 }
 
 void UPawn::SetMoveDuration(const vec3& deltaMove)
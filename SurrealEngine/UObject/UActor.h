@@ -2,6 +2,8 @@
 
 #include "UObject.h"
 
+class UStruct;
+enum class LatentRunState;
 class UTexture;
 class UMesh;
 class UModel;
@@ -141,6 +143,16 @@ enum ELightEffect
 	LE_Unused
 };
 
+// Actor variables the level keeps state for. Script assigning one of them calls UActor::TrackedPropertyChanged.
+enum class TrackedProperty : uint8_t
+{
+	None,
+	Tag, // ULevel tag index
+	Tick, // UActor::NeedsTick
+	TimerRate, // ULevel timer wheel
+	TimerCounter // Also worked out from the timer wheel when read
+};
+
 class UActor : public UObject
 {
 public:
@@ -158,6 +170,19 @@ public:
 
 	virtual void Tick(float elapsed, bool tickedFlag);
 
+	// Returns false if ticking the actor would do nothing, in which case the level stops ticking it until it is woken up
+	virtual bool NeedsTick();
+	void WakeUp();
+
+	static TrackedProperty GetTrackedProperty(UProperty* prop);
+	void TrackedPropertyChanged(TrackedProperty property);
+
+	void GotoState(NameString stateName, const NameString& labelName) override;
+
+	// Latent functions suspend the state code until their wake condition is met. Resuming hands it to the scheduler in ULevel.
+	void SuspendStateCode(LatentRunState condition);
+	void ResumeStateCode(LatentRunState condition);
+
 	void TickAnimation(float elapsed);
 
 	void TickPhysics(float elapsed);
@@ -211,12 +236,35 @@ public:
 	struct
 	{
 		bool Inserted = false;
+		bool Colliding = false;
 		vec3 Location = { 0.0f };
 		float Height = 0.0f;
 		float Radius = 0.0f;
 	} CollisionHashInfo;
 
-	float SleepTimeLeft = 0.0f;
+	// Bumped whenever the timer or sleep is rescheduled, which invalidates the older entries in the level timer wheel
+	uint32_t TimerGeneration = 0;
+	uint32_t SleepGeneration = 0;
+
+	// While the timer is scheduled, TimerCounter is only brought up to date from TimerStart (when it was last zero) as it gets read
+	double TimerStart = 0.0;
+	bool TimerRunning = false;
+
+	// Set while ULevel::Tick skips the actor
+	bool Dormant = false;
+
+	// Set while the actor is in the state code queue of the level
+	bool StateCodeScheduled = false;
+
+	// Whether the current class and state has a Tick event
+	UClass* TickEventClass = nullptr;
+	UStruct* TickEventState = nullptr;
+	bool HasTickEvent = false;
+
+	// Actors with this actor as their Owner or Base (the level is never tracked as a base)
+	std::vector<UActor*> OwnedChildren;
+	std::vector<UActor*> BasedChildren;
+	static void RemoveChildActor(std::vector<UActor*>& list, UActor* actor);
 
 	// Cached calculations needed by the renderer
 	bool lightsCalculated = false;
@@ -1535,6 +1583,7 @@ public:
 
 	void Tick(float elapsed, bool tickedFlag) override;
 	void TickRotating(float elapsed) override;
+	bool NeedsTick() override { return true; }
 
 	void InitActorZone() override;
 	void UpdateActorZone() override;
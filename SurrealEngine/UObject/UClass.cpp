@@ -5,6 +5,7 @@
 #include "UProperty.h"
 #include "VM/Bytecode.h"
 #include "VM/NativeFunc.h"
+#include "VM/ScriptCache.h"
 #include "Package/PackageManager.h"
 
 void UField::Load(ObjectStream* stream)
@@ -59,14 +60,28 @@ void UStruct::Load(ObjectStream* stream)
 
 	int ScriptSize = stream->ReadUInt32();
 
-	while (Bytecode.size() < ScriptSize)
+	ScriptCache* cache = stream->GetPackage()->GetScriptCache();
+	uint32_t scriptOffset = stream->Tell();
+	uint32_t diskSize = 0;
+	if (cache && cache->Find(scriptOffset, ScriptSize, diskSize, Bytecode))
 	{
-		ReadToken(stream, 0);
+		stream->Skip(diskSize);
 	}
-	if (Bytecode.size() != ScriptSize)
-		throw std::runtime_error("Bytecode load failed");
+	else
+	{
+		while (Bytecode.size() < ScriptSize)
+		{
+			ReadToken(stream, 0);
+		}
+		if (Bytecode.size() != ScriptSize)
+			throw std::runtime_error("Bytecode load failed");
 
-	Code = std::make_shared<::Bytecode>(Bytecode, stream->GetPackage());
+		if (cache && ScriptSize != 0)
+			cache->Add(scriptOffset, stream->Tell() - scriptOffset, Bytecode);
+	}
+
+	Bytecode.shrink_to_fit();
+	CodePackage = stream->GetPackage();
 
 	size_t offset = 0;
 	if (BaseStruct)
@@ -160,6 +175,19 @@ static const char* tokennames[256] =
 };
 #endif
 
+void UStruct::DecodeBytecode()
+{
+	Code = std::make_shared<::Bytecode>(Bytecode, CodePackage);
+	if (CompiledScript::IsActive())
+	{
+		Code->Hash = CompiledScript::GetHash(this, Bytecode);
+		Code->Compiled = CompiledScript::Find(CodePackage, this, Code->Hash, Code->Instructions.size());
+	}
+
+	// The expression tree is all that is used from here on
+	std::vector<uint8_t>().swap(Bytecode);
+}
+
 ExprToken UStruct::ReadToken(ObjectStream* stream, int depth)
 {
 	if (depth == 64)
@@ -283,6 +311,24 @@ ExprToken UStruct::ReadToken(ObjectStream* stream, int depth)
 	return token;
 }
 
+bool UStruct::CheckTriviallyCopyable()
+{
+	for (UProperty* prop : Properties)
+	{
+		if (UStructProperty* structProp = UObject::TryCast<UStructProperty>(prop))
+		{
+			if (!structProp->Struct || !structProp->Struct->IsTriviallyCopyable())
+				return false;
+		}
+		else if (!UObject::TryCast<UIntProperty>(prop) && !UObject::TryCast<UFloatProperty>(prop) && !UObject::TryCast<UBoolProperty>(prop) &&
+			!UObject::TryCast<UByteProperty>(prop) && !UObject::TryCast<UObjectProperty>(prop) && !UObject::TryCast<UNameProperty>(prop) && !UObject::TryCast<UPointerProperty>(prop))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
 void UStruct::PushBytes(const void* data, size_t size)
 {
 	Bytecode.insert(Bytecode.end(), (const uint8_t*)data, (const uint8_t*)data + size);
@@ -339,6 +385,36 @@ void UFunction::Load(ObjectStream* stream)
 	FuncFlags = (FunctionFlags)stream->ReadUInt32();
 	if (AllFlags(FuncFlags, FunctionFlags::Net))
 		ReplicationOffset = stream->ReadUInt16();
+
+	for (UField* field = Children; field != nullptr; field = field->Next)
+	{
+		UProperty* prop = dynamic_cast<UProperty*>(field);
+		if (prop)
+		{
+			Layout.Locals.push_back(prop);
+
+			if (AllFlags(prop->PropFlags, PropertyFlags::Parm | PropertyFlags::OutParm))
+				Layout.OutParms.push_back({ prop, (int)Layout.Parms.size() });
+
+			if (AllFlags(prop->PropFlags, PropertyFlags::ReturnParm) && !Layout.ReturnParm)
+			{
+				Layout.ReturnParm = prop;
+				Layout.ReturnIsParm = AllFlags(prop->PropFlags, PropertyFlags::Parm);
+			}
+
+			if (AllFlags(prop->PropFlags, PropertyFlags::Parm))
+				Layout.Parms.push_back(prop);
+
+			// Only these types use the default memset Construct and empty Destruct (names are intern indexes, where zero is None)
+			bool trivial = dynamic_cast<UIntProperty*>(prop) || dynamic_cast<UFloatProperty*>(prop) || dynamic_cast<UBoolProperty*>(prop) ||
+				dynamic_cast<UByteProperty*>(prop) || dynamic_cast<UObjectProperty*>(prop) || dynamic_cast<UNameProperty*>(prop) || dynamic_cast<UPointerProperty*>(prop);
+			if (!trivial)
+			{
+				Layout.NonTrivialLocals.push_back(prop);
+				Layout.TrivialLocals = false;
+			}
+		}
+	}
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -363,16 +439,24 @@ static const char* probeNames[64] =
 	"Probe60",      "Probe61",         "Probe62",         "All"
 };
 
-bool UState::IsMaskedProbeName(const NameString& probeName)
+int UState::GetProbeIndex(const NameString& probeName)
 {
-	static std::set<NameString> maskedProbeNames;
-
-	if (!maskedProbeNames.empty())
-		return maskedProbeNames.find(probeName) != maskedProbeNames.end();
-	
-	for (int i = 0; i < 64; i++)
-		maskedProbeNames.insert(probeNames[i]);
-	return maskedProbeNames.find(probeName) != maskedProbeNames.end();
+	// Indexed by name pool index. Names interned after this table was built can't be probe names.
+	static std::vector<int8_t> probeIndexes;
+
+	if (probeIndexes.empty())
+	{
+		for (int i = 0; i < 64; i++)
+		{
+			uint32_t nameIndex = NameString(probeNames[i]).GetIndex();
+			if (probeIndexes.size() <= nameIndex)
+				probeIndexes.resize(nameIndex + 1, -1);
+			probeIndexes[nameIndex] = i;
+		}
+	}
+
+	uint32_t nameIndex = probeName.GetIndex();
+	return nameIndex < probeIndexes.size() ? probeIndexes[nameIndex] : -1;
 }
 
 void UState::Load(ObjectStream* stream)
@@ -383,18 +467,6 @@ void UState::Load(ObjectStream* stream)
 	LabelTableOffset = stream->ReadUInt16();
 	StateFlags = (ScriptStateFlags)stream->ReadUInt32();
 
-	for (int i = 0; i < 64; i++)
-	{
-		if (ProbeMask & (1LL << i))
-		{
-			Probes.insert(probeNames[i]);
-		}
-		if ((IgnoreMask & (1LL << i)) == 0)
-		{
-			IgnoreProbes.insert(probeNames[i]);
-		}
-	}
-
 	for (UField* child = Children; child; child = child->Next)
 	{
 		if (UObject::TryCast<UFunction>(child))
@@ -410,6 +482,60 @@ UClass::UClass(NameString name, UClass* base, ObjectFlags flags) : UState(std::m
 {
 }
 
+UFunction* UClass::FindFunction(const NameString& name)
+{
+	if (!VTablesBuilt)
+		BuildVTables();
+
+	auto it = VTable.find(name);
+	return it != VTable.end() ? it->second : nullptr;
+}
+
+UFunction* UClass::FindStateFunction(const NameString& stateName, const NameString& name)
+{
+	if (!VTablesBuilt)
+		BuildVTables();
+
+	auto itState = StateVTables.find(stateName);
+	if (itState == StateVTables.end())
+		return nullptr;
+
+	auto it = itState->second.find(name);
+	return it != itState->second.end() ? it->second : nullptr;
+}
+
+void UClass::BuildAncestors()
+{
+	for (UClass* cls = this; cls != nullptr; cls = static_cast<UClass*>(cls->BaseStruct))
+		Ancestors.push_back(cls);
+	std::reverse(Ancestors.begin(), Ancestors.end());
+	Depth = Ancestors.size() - 1;
+}
+
+bool UClass::IsChildOfSlow(const UClass* parent)
+{
+	const_cast<UClass*>(parent)->BuildAncestors();
+	return parent->Depth < Ancestors.size() && Ancestors[parent->Depth] == parent;
+}
+
+void UClass::BuildVTables()
+{
+	// Walk from the most derived class towards the root so that overrides win
+	for (UClass* cls = this; cls != nullptr; cls = static_cast<UClass*>(cls->BaseStruct))
+	{
+		for (auto& it : cls->Functions)
+			VTable.insert(it);
+
+		for (auto& itState : cls->States)
+		{
+			auto& table = StateVTables[itState.first];
+			for (auto& it : itState.second->Functions)
+				table.insert(it);
+		}
+	}
+	VTablesBuilt = true;
+}
+
 void UClass::Load(ObjectStream* stream)
 {
 	UState::Load(stream);
@@ -467,7 +593,7 @@ void UClass::Load(ObjectStream* stream)
 			{
 				NameString name = prop->Name;
 				if (prop->ArrayDimension > 1)
-					name.Value += "[" + std::to_string(arrayIndex) + "]";
+					name = name.ToString() + "[" + std::to_string(arrayIndex) + "]";
 
 				std::string value;
 				if (isConfig)
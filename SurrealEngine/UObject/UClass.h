@@ -55,12 +55,25 @@ public:
 #endif
 	UStruct* StructParent = nullptr;
 	std::vector<uint8_t> Bytecode;
-	std::shared_ptr<::Bytecode> Code;
+
+	// Script code is decoded the first time it is needed
+	::Bytecode* GetCode() { if (!Code) DecodeBytecode(); return Code.get(); }
 
 	size_t StructSize = 0;
 	std::vector<UProperty*> Properties;
 
+	// True if the struct only holds plain data that can be copied with memcpy
+	bool IsTriviallyCopyable() { if (TriviallyCopyable == -1) TriviallyCopyable = CheckTriviallyCopyable(); return TriviallyCopyable == 1; }
+
 private:
+	void DecodeBytecode();
+	bool CheckTriviallyCopyable();
+
+	int8_t TriviallyCopyable = -1;
+
+	std::shared_ptr<::Bytecode> Code;
+	Package* CodePackage = nullptr;
+
 	ExprToken ReadToken(ObjectStream* stream, int depth);
 	void PushBytes(const void* data, size_t size);
 	void PushUInt8(uint8_t value);
@@ -98,12 +111,25 @@ inline FunctionFlags operator&(FunctionFlags a, FunctionFlags b) { return (Funct
 inline bool AllFlags(FunctionFlags value, FunctionFlags flags) { return (value & flags) == flags; }
 inline bool AnyFlags(FunctionFlags value, FunctionFlags flags) { return (uint32_t)(value & flags) != 0; }
 
+struct FunctionLayout
+{
+	std::vector<UProperty*> Parms; // All Parm properties in declaration order (including the return value)
+	std::vector<UProperty*> Locals; // All properties, parms included, in declaration order
+	std::vector<UProperty*> NonTrivialLocals; // Properties needing Construct/Destruct calls
+	std::vector<std::pair<UProperty*, int>> OutParms; // Out parameters with their argument index
+	UProperty* ReturnParm = nullptr;
+	bool ReturnIsParm = false; // Return value passed as a Parm (natives receive it as an extra argument)
+	bool TrivialLocals = true; // All locals can be constructed with a memset
+};
+
 class UFunction : public UStruct
 {
 public:
 	using UStruct::UStruct;
 	void Load(ObjectStream* stream) override;
 
+	FunctionLayout Layout;
+
 	int ParmsSize = 0;
 	int NativeFuncIndex = 0;
 	int NumParms = 0;
@@ -133,12 +159,11 @@ public:
 	using UStruct::UStruct;
 	void Load(ObjectStream* stream) override;
 
-	static bool IsMaskedProbeName(const NameString& probeName);
+	// Bit of the probe event in ProbeMask and IgnoreMask, or -1 if the name is not a probe
+	static int GetProbeIndex(const NameString& probeName);
 
-	std::set<NameString> Probes;
-	std::set<NameString> IgnoreProbes;
-	uint64_t ProbeMask = 0;
-	uint64_t IgnoreMask = 0;
+	uint64_t ProbeMask = 0; // Probe events with a function in this state
+	uint64_t IgnoreMask = 0; // Probe events not in the 'ignores' list of this state
 	uint16_t LabelTableOffset = 0;
 	ScriptStateFlags StateFlags = {};
 
@@ -178,7 +203,30 @@ public:
 	UState* GetState(const NameString& name) { auto it = States.find(name); if (it != States.end()) return it->second; else return nullptr; }
 	std::map<NameString, UState*> States;
 
+	// Constant time ancestry test using the per-depth ancestor table
+	bool IsChildOf(const UClass* parent)
+	{
+		if (Ancestors.empty())
+			BuildAncestors();
+		return parent->Ancestors.empty() ? IsChildOfSlow(parent) : parent->Depth < Ancestors.size() && Ancestors[parent->Depth] == parent;
+	}
+
+	// Lookups through the flattened dispatch tables (includes all base classes)
+	UFunction* FindFunction(const NameString& name);
+	UFunction* FindStateFunction(const NameString& stateName, const NameString& name);
+
 private:
+	void BuildVTables();
+	void BuildAncestors();
+	bool IsChildOfSlow(const UClass* parent);
+
+	std::vector<UClass*> Ancestors; // Ancestors[i] is the ancestor at depth i (the root is at depth 0, this class is last)
+	size_t Depth = 0;
+
+	bool VTablesBuilt = false;
+	std::map<NameString, UFunction*> VTable;
+	std::map<NameString, std::map<NameString, UFunction*>> StateVTables;
+
 	std::map<NameString, std::string> ParseStructValue(const std::string& text);
 };
 
@@ -32,6 +32,7 @@ public:
 	~UInternetLink();
 
 	void Tick(float elapsed, bool tickedFlag) override;
+	bool NeedsTick() override { return true; }
 
 	int GetLastError();
 	IpAddr GetLocalIP();
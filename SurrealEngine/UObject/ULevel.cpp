@@ -5,6 +5,7 @@
 #include "UTexture.h"
 #include "UClass.h"
 #include "VM/ScriptCall.h"
+#include "VM/Frame.h"
 #include "Collision/TraceRayLevel.h"
 #include "Collision/TraceRayModel.h"
 #include "Collision/TraceCylinderLevel.h"
@@ -67,11 +68,22 @@ void ULevel::Load(ObjectStream* stream)
 
 void ULevel::Tick(float elapsed)
 {
+	ExpiredTimers.clear();
+	Timers.Advance(Timers.GetTime() + elapsed, ExpiredTimers);
+
+	// Resume sleeping state code, so that it continues this frame
+	for (const TimerEntry& entry : ExpiredTimers)
+	{
+		UActor* actor = entry.Actor;
+		if (entry.Type == TimerType::Sleep && entry.Generation == actor->SleepGeneration && !actor->bDeleteMe())
+			actor->ResumeStateCode(LatentRunState::Sleep);
+	}
+
 	// To do: owned actors must tick before their children:
-	for (size_t i = 0; i < Actors.size(); i++)
+	for (size_t i = 0; i < TickingActors.size(); i++)
 	{
-		UActor* actor = Actors[i];
-		if (actor)
+		UActor* actor = TickingActors[i];
+		if (!actor->bDeleteMe())
 		{
 			actor->Tick(elapsed, ticked);
 
@@ -87,18 +99,212 @@ void ULevel::Tick(float elapsed)
 		}
 	}
 
-	std::vector<UActor*> newActorList;
-	newActorList.reserve(Actors.size());
-	for (UActor* actor : Actors)
+	RunStateCode();
+
+	// Actors with nothing left to do become dormant until something wakes them up again
+	size_t tickingCount = 0;
+	for (UActor* actor : TickingActors)
 	{
-		if (actor)
-			newActorList.push_back(actor);
+		if (actor->bDeleteMe())
+			continue;
+
+		if (actor->NeedsTick())
+			TickingActors[tickingCount++] = actor;
+		else
+			actor->Dormant = true;
+	}
+	TickingActors.resize(tickingCount);
+
+	for (const TimerEntry& entry : ExpiredTimers)
+	{
+		if (entry.Type == TimerType::Timer)
+			FireTimer(entry);
+	}
+
+	if (ActorIndexHasNulls)
+	{
+		Actors.erase(std::remove(Actors.begin(), Actors.end(), (UActor*)nullptr), Actors.end());
+		CompactActorIndex();
 	}
-	Actors.swap(newActorList);
 
 	ticked = !ticked;
 }
 
+void ULevel::ScheduleTimer(UActor* actor)
+{
+	actor->TimerGeneration++;
+	actor->TimerRunning = actor->TimerRate() > 0.0f;
+	if (actor->TimerRunning)
+	{
+		actor->TimerStart = Timers.GetTime() - actor->TimerCounter();
+		Timers.Add(actor, TimerType::Timer, actor->TimerGeneration, actor->TimerStart + actor->TimerRate());
+	}
+}
+
+void ULevel::UpdateTimerCounter(UActor* actor)
+{
+	// The counter does not advance while no timer is running
+	if (actor->TimerRunning)
+		actor->TimerCounter() = (float)(Timers.GetTime() - actor->TimerStart);
+}
+
+void ULevel::ScheduleSleep(UActor* actor, float seconds)
+{
+	actor->SleepGeneration++;
+	Timers.Add(actor, TimerType::Sleep, actor->SleepGeneration, Timers.GetTime() + seconds);
+}
+
+void ULevel::ScheduleStateCode(UActor* actor)
+{
+	if (!actor->StateCodeScheduled)
+	{
+		actor->StateCodeScheduled = true;
+		StateCodeQueue.push_back(actor);
+	}
+}
+
+void ULevel::RunStateCode()
+{
+	// State code may resume other actors, which are then run in the same pass
+	for (size_t i = 0; i < StateCodeQueue.size(); i++)
+	{
+		UActor* actor = StateCodeQueue[i];
+		actor->StateCodeScheduled = false;
+		if (!actor->bDeleteMe() && actor->Role() >= ROLE_SimulatedProxy && actor->StateFrame)
+			actor->StateFrame->Tick();
+	}
+	StateCodeQueue.clear();
+}
+
+void ULevel::FireTimer(const TimerEntry& entry)
+{
+	UActor* actor = entry.Actor;
+	double deadline = entry.Deadline;
+	while (entry.Generation == actor->TimerGeneration && !actor->bDeleteMe() && actor->TimerRate() > 0.0f)
+	{
+		actor->TimerCounter() = 0.0f;
+		actor->TimerStart = deadline;
+		if (!actor->bTimerLoop())
+		{
+			actor->TimerRate() = 0.0f;
+			actor->TimerRunning = false;
+		}
+
+		CallEvent(actor, "Timer");
+
+		// Stop if the timer was cleared or restarted by SetTimer during the event
+		if (entry.Generation != actor->TimerGeneration || actor->bDeleteMe() || actor->TimerRate() <= 0.0f)
+			break;
+
+		// Looping timers keep their cadence and catch up if the rate is shorter than the frame
+		deadline += actor->TimerRate();
+		if (deadline > Timers.GetTime())
+		{
+			Timers.Add(actor, TimerType::Timer, entry.Generation, deadline);
+			break;
+		}
+	}
+}
+
+void ULevel::WakeActor(UActor* actor)
+{
+	if (actor->Dormant && !actor->bDeleteMe())
+	{
+		actor->Dormant = false;
+		TickingActors.push_back(actor);
+	}
+}
+
+void ULevel::AddToActorIndex(UActor* actor)
+{
+	static const NameString actorName = "Actor";
+	for (UClass* cls = actor->Class; cls && cls->Name != actorName; cls = static_cast<UClass*>(cls->BaseStruct))
+		ActorsByClass[cls].push_back(actor);
+	ActorsByTag[actor->Tag()].push_back(actor);
+	TickingActors.push_back(actor);
+
+	// State code that was already running when the map was saved
+	if (actor->StateFrame && actor->StateFrame->LatentState == LatentRunState::Continue)
+		ScheduleStateCode(actor);
+
+	// Timers set in the map or in the class defaults
+	if (actor->TimerRate() > 0.0f)
+		ScheduleTimer(actor);
+
+	// Actors placed in the map already have their owner and base set
+	if (actor->Owner())
+		actor->Owner()->OwnedChildren.push_back(actor);
+	if (actor->ActorBase() && actor->ActorBase() != actor->Level())
+		actor->ActorBase()->BasedChildren.push_back(actor);
+}
+
+void ULevel::RemoveFromActorIndex(UActor* actor)
+{
+	static const NameString actorName = "Actor";
+	for (UClass* cls = actor->Class; cls && cls->Name != actorName; cls = static_cast<UClass*>(cls->BaseStruct))
+	{
+		auto it = ActorsByClass.find(cls);
+		if (it != ActorsByClass.end())
+			std::replace(it->second.begin(), it->second.end(), actor, (UActor*)nullptr);
+	}
+
+	// The actor may have been indexed under an older tag if it changed since the last rebuild
+	auto it = ActorsByTag.find(actor->Tag());
+	if (it == ActorsByTag.end() || std::find(it->second.begin(), it->second.end(), actor) == it->second.end())
+	{
+		for (auto& tagList : ActorsByTag)
+			std::replace(tagList.second.begin(), tagList.second.end(), actor, (UActor*)nullptr);
+	}
+	else
+	{
+		std::replace(it->second.begin(), it->second.end(), actor, (UActor*)nullptr);
+	}
+
+	ActorIndexHasNulls = true;
+}
+
+const std::vector<UActor*>& ULevel::GetActorsOfClass(UClass* cls)
+{
+	static const NameString actorName = "Actor";
+	static const NameString objectName = "Object";
+	if (cls->Name == actorName || cls->Name == objectName)
+		return Actors;
+	return ActorsByClass[cls];
+}
+
+const std::vector<UActor*>& ULevel::GetActorsWithTag(const NameString& tag)
+{
+	if (TagsModified)
+	{
+		// Rebuilding would reorder the lists under the running iterators. The caller filters on the tag, so the full list is a correct fallback.
+		if (TagIterators > 0)
+			return Actors;
+		RebuildTagIndex();
+	}
+	return ActorsByTag[tag];
+}
+
+void ULevel::CompactActorIndex()
+{
+	for (auto& it : ActorsByClass)
+		it.second.erase(std::remove(it.second.begin(), it.second.end(), (UActor*)nullptr), it.second.end());
+	for (auto& it : ActorsByTag)
+		it.second.erase(std::remove(it.second.begin(), it.second.end(), (UActor*)nullptr), it.second.end());
+	ActorIndexHasNulls = false;
+}
+
+void ULevel::RebuildTagIndex()
+{
+	// Only called with no tagged iterators live (see GetActorsWithTag)
+	ActorsByTag.clear();
+	for (UActor* actor : Actors)
+	{
+		if (actor)
+			ActorsByTag[actor->Tag()].push_back(actor);
+	}
+	TagsModified = false;
+}
+
 SweepHit ULevel::TraceFirstHit(const vec3& from, const vec3& to, UActor* tracingActor, const vec3& extents, const TraceFlags& flags)
 {
 	for (const SweepHit& hit : Trace(from, to, extents.z, extents.x, flags.traceActors(), flags.traceWorld(), false))
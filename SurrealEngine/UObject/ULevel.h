@@ -4,6 +4,7 @@
 #include "Math/bbox.h"
 #include "Collision/CollisionHash.h"
 #include "Collision/TraceHit.h"
+#include "TimerWheel.h"
 
 class UTexture;
 class UActor;
@@ -245,6 +246,28 @@ public:
 
 	bool TraceRayAnyHit(vec3 from, vec3 to, UActor* tracingActor, bool traceActors, bool traceWorld, bool visibilityOnly);
 
+	void AddToActorIndex(UActor* actor);
+	void RemoveFromActorIndex(UActor* actor);
+	const std::vector<UActor*>& GetActorsOfClass(UClass* cls);
+	const std::vector<UActor*>& GetActorsWithTag(const NameString& tag);
+
+	// Set through UActor::TrackedPropertyChanged when the tag of an indexed actor changes, making the tag index stale
+	bool TagsModified = false;
+
+	// Tagged AllActors iterators walking a tag list. The tag index is not rebuilt while any are live.
+	int TagIterators = 0;
+
+	// Puts a dormant actor back on the list of actors ticked every frame
+	void WakeActor(UActor* actor);
+
+	// (Re)starts the actor timer from its current TimerRate and TimerCounter
+	void ScheduleTimer(UActor* actor);
+	void UpdateTimerCounter(UActor* actor);
+	void ScheduleSleep(UActor* actor, float seconds);
+
+	// Queues resumed state code to run at the end of the actor tick loop
+	void ScheduleStateCode(UActor* actor);
+
 	std::vector<LevelReachSpec> ReachSpecs;
 	UModel* Model = nullptr;
 
@@ -254,7 +277,26 @@ public:
 	std::map<std::string, std::string> TravelInfo;
 
 private:
+	void CompactActorIndex();
+	void RebuildTagIndex();
+	void FireTimer(const TimerEntry& entry);
+	void RunStateCode();
+
 	bool ticked = false;
+
+	// Spawned actors are listed under their class and every base class below Actor. Destroyed actors leave a null entry until the end of the tick.
+	std::unordered_map<UClass*, std::vector<UActor*>> ActorsByClass;
+	std::unordered_map<NameString, std::vector<UActor*>> ActorsByTag;
+	bool ActorIndexHasNulls = false;
+
+	// Actors that are not dormant. Actors are only removed at the end of the tick, after which NeedsTick is checked again when they wake up.
+	std::vector<UActor*> TickingActors;
+
+	TimerWheel Timers;
+	std::vector<TimerEntry> ExpiredTimers;
+
+	// Suspended state code costs nothing until its wake condition puts it in here
+	std::vector<UActor*> StateCodeQueue;
 };
 
 class ULevelSummary : public UObject
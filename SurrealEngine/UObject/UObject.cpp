@@ -9,6 +9,9 @@
 #include "VM/Frame.h"
 #include "Engine.h"
 
+uint16_t NativeTypes::NextTag = 1;
+NativeTypes::CastResult NativeTypes::CastResults[MaxTypes][MaxTypes];
+
 UObject::UObject(NameString name, UClass* cls, ObjectFlags flags) : Name(name), Class(cls), Flags(flags)
 {
 }
@@ -229,37 +232,53 @@ bool UObject::IsA(const NameString& className) const
 	return false;
 }
 
+bool UObject::IsA(UClass* cls) const
+{
+	return Class->IsChildOf(cls);
+}
+
 bool UObject::IsEventEnabled(const NameString& name) const
 {
-	NameString stateName = GetStateName();
-	if (UState::IsMaskedProbeName(name))
+	int probe = UState::GetProbeIndex(name);
+	if (probe != -1)
 	{
-		bool foundProbe = false;
-		if (StateFrame && StateFrame->Func)
-		{
-			UState* state = static_cast<UState*>(StateFrame->Func);
+		UStruct* state = StateFrame ? StateFrame->Func : nullptr;
+		if (!ProbeMaskValid || ProbeMaskState != state)
+			UpdateProbeMask();
+		return (EnabledProbes >> probe) & 1;
+	}
 
-			// Probe is in the ignore list ('ignores' keyword in unrealscript)
-			if (state->IgnoreProbes.find(name) != state->IgnoreProbes.end())
-			{
-				return false;
-			}
+	if (DisabledEvents.empty())
+		return true;
 
-			// We have a function for the probe
-			if (state->Probes.find(name) != state->Probes.end())
-				foundProbe = true;
-		}
+	auto it = DisabledEvents.find(GetStateName());
+	return it == DisabledEvents.end() || it->second.find(name) == it->second.end();
+}
 
-		// Maybe the class has a function for our probe?
-		if (Class->Probes.find(name) != Class->Probes.end())
-			foundProbe = true;
+void UObject::UpdateProbeMask() const
+{
+	// A probe is enabled if the class or state has a function for it, it is not in the 'ignores' list of the state and it wasn't disabled
+	uint64_t mask = Class->ProbeMask;
+	if (StateFrame && StateFrame->Func)
+	{
+		UState* state = static_cast<UState*>(StateFrame->Func);
+		mask = (mask | state->ProbeMask) & state->IgnoreMask;
+	}
 
-		if (!foundProbe)
-			return false;
+	auto it = DisabledEvents.find(GetStateName());
+	if (it != DisabledEvents.end())
+	{
+		for (const NameString& name : it->second)
+		{
+			int probe = UState::GetProbeIndex(name);
+			if (probe != -1)
+				mask &= ~((uint64_t)1 << probe);
+		}
 	}
 
-	auto it = DisabledEvents.find(stateName);
-	return it == DisabledEvents.end() || it->second.find(name) == it->second.end();
+	EnabledProbes = mask;
+	ProbeMaskState = StateFrame ? StateFrame->Func : nullptr;
+	ProbeMaskValid = true;
 }
 
 std::string UObject::PrintProperties()
@@ -5,10 +5,12 @@
 #include "Math/mat.h"
 #include "Math/rotator.h"
 #include "PropertyOffsets.h"
+#include "NativeTypes.h"
 #include <set>
 
 class UObject;
 class UClass;
+class UStruct;
 class UProperty;
 class Package;
 class Frame;
@@ -160,33 +162,43 @@ public:
 	void SetObject(const NameString& name, const UObject* value);
 
 	bool IsA(const NameString& className) const;
+	bool IsA(UClass* cls) const;
 
 	bool IsEventEnabled(const NameString& name) const;
+	void UpdateProbeMask() const;
 
 	void EnableEvent(const NameString& name)
 	{
 		NameString stateName = GetStateName();
 		DisabledEvents[stateName].erase(name);
+		ProbeMaskValid = false;
 	}
 
 	void DisableEvent(const NameString& name)
 	{
 		NameString stateName = GetStateName();
 		DisabledEvents[stateName].insert(name);
+		ProbeMaskValid = false;
 	}
 
 	NameString GetStateName() const;
-	void GotoState(NameString stateName, const NameString& labelName);
+	virtual void GotoState(NameString stateName, const NameString& labelName);
 
 	std::string PrintProperties();
 
 	std::map<NameString, std::set<NameString>> DisabledEvents;
 
+	// Probe events enabled for the state the mask was built for. State changes are detected by comparing the state.
+	mutable uint64_t EnabledProbes = 0;
+	mutable UStruct* ProbeMaskState = nullptr;
+	mutable bool ProbeMaskValid = false;
+
 	std::unique_ptr<ObjectDelayLoad> DelayLoad;
 
 	NameString Name;
 	UClass* Class = nullptr;
 	ObjectFlags Flags = ObjectFlags::NoFlags;
+	uint16_t NativeType = 0; // Set by the factory from Package::RegisterNativeClass
 
 	PropertyDataBlock PropertyData;
 	std::shared_ptr<Frame> StateFrame;
@@ -200,7 +212,7 @@ public:
 	template<typename T>
 	static T* Cast(UObject* obj)
 	{
-		T* target = dynamic_cast<T*>(obj);
+		T* target = TryCast<T>(obj);
 		if (target == nullptr && obj != nullptr)
 		{
 			throw std::runtime_error("Could not cast object " + obj->Name.ToString() + " (class " + GetUClassName(obj).ToString() + ") to " + (std::string)typeid(T).name());
@@ -211,7 +223,14 @@ public:
 	template<typename T>
 	static T* TryCast(UObject* obj)
 	{
-		return dynamic_cast<T*>(obj);
+		uint16_t targetType = NativeTypes::GetTag<T>();
+		if (!obj || obj->NativeType == 0 || targetType == 0)
+			return dynamic_cast<T*>(obj);
+
+		NativeTypes::CastResult& result = NativeTypes::CastResults[obj->NativeType][targetType];
+		if (result == NativeTypes::Unknown)
+			result = dynamic_cast<T*>(obj) ? NativeTypes::Succeeds : NativeTypes::Fails;
+		return result == NativeTypes::Succeeds ? static_cast<T*>(obj) : nullptr;
 	}
 
 	static NameString GetUClassName(UObject* obj);
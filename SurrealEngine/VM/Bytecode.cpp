@@ -1,8 +1,28 @@
 
 #include "Precomp.h"
 #include "Bytecode.h"
+#include "ExpressionEvaluator.h"
+#include "NativeFunc.h"
+#include "UObject/UActor.h"
 
-Bytecode::Bytecode(const std::vector<uint8_t>& bytecode, Package* package)
+ExpressionArena::~ExpressionArena()
+{
+	for (auto it = Nodes.rbegin(); it != Nodes.rend(); ++it)
+		(*it)->~Expression();
+}
+
+void* ExpressionArena::AllocBlock(size_t size)
+{
+	// Expression nodes are always aligned to 16 bytes or less, which new[] guarantees
+	size_t blockSize = std::max(BlockSize, size);
+	Blocks.push_back(std::make_unique<uint8_t[]>(blockSize));
+	CurrentSize = blockSize;
+	CurrentOffset = size;
+	return Blocks.back().get();
+}
+
+// Roughly one node per three bytes of script, which keeps most functions in a single block
+Bytecode::Bytecode(const std::vector<uint8_t>& bytecode, Package* package) : Arena(std::min(std::max(bytecode.size() * 16, (size_t)1024), (size_t)64 * 1024))
 {
 	BytecodeStream stream(bytecode.data(), bytecode.size(), package);
 	while (!stream.IsEnd())
@@ -10,6 +30,199 @@ Bytecode::Bytecode(const std::vector<uint8_t>& bytecode, Package* package)
 		Statements.push_back(ReadToken(&stream, 0));
 		Statements.back()->StatementIndex = (int)Statements.size() - 1;
 	}
+	Compile();
+}
+
+void Bytecode::Compile()
+{
+	auto findTarget = [&](uint16_t offset) -> int
+	{
+		auto it = OffsetToExpression.find(offset);
+		return it != OffsetToExpression.end() ? it->second->StatementIndex : (int)Statements.size();
+	};
+
+	Instructions.reserve(Statements.size());
+	for (Expression* statement : Statements)
+	{
+		Instruction inst;
+		inst.Operand = statement;
+
+		if (auto expr = dynamic_cast<JumpExpression*>(statement))
+		{
+			inst.Op = Opcode::Jump;
+			inst.Target = findTarget(expr->Offset);
+		}
+		else if (auto expr = dynamic_cast<JumpIfNotExpression*>(statement))
+		{
+			inst.Op = Opcode::JumpIfNot;
+			inst.Target = findTarget(expr->Offset);
+			inst.Operand = expr->Condition;
+		}
+		else if (auto expr = dynamic_cast<SwitchExpression*>(statement))
+		{
+			inst.Op = Opcode::Switch;
+			inst.Operand = expr->Condition;
+		}
+		else if (auto expr = dynamic_cast<CaseExpression*>(statement))
+		{
+			inst.Op = Opcode::Case;
+			inst.Operand = expr->Value;
+			if (expr->NextOffset != 0xffff)
+				inst.Target = findTarget(expr->NextOffset);
+		}
+		else if (auto expr = dynamic_cast<GotoLabelExpression*>(statement))
+		{
+			inst.Op = Opcode::GotoLabel;
+			inst.Operand = expr->Value;
+		}
+		else if (auto expr = dynamic_cast<ReturnExpression*>(statement))
+		{
+			inst.Op = Opcode::Return;
+			inst.Operand = expr->Value;
+		}
+		else if (auto expr = dynamic_cast<IteratorExpression*>(statement))
+		{
+			inst.Op = Opcode::Iterator;
+			inst.Target = findTarget(expr->Offset);
+			inst.Operand = expr->Value;
+		}
+		else if (dynamic_cast<StopExpression*>(statement))
+		{
+			inst.Op = Opcode::Stop;
+		}
+		else if (dynamic_cast<IteratorNextExpression*>(statement))
+		{
+			inst.Op = Opcode::IteratorNext;
+		}
+		else if (dynamic_cast<IteratorPopExpression*>(statement))
+		{
+			inst.Op = Opcode::IteratorPop;
+		}
+		else if (dynamic_cast<NothingExpression*>(statement))
+		{
+			inst.Op = Opcode::Nothing;
+		}
+
+		Instructions.push_back(inst);
+	}
+
+	// Collapse jump chains so that a jump lands on the first statement doing actual work
+	for (Instruction& inst : Instructions)
+	{
+		if (inst.Op == Opcode::Jump || inst.Op == Opcode::JumpIfNot)
+		{
+			for (size_t hops = 0; hops < Instructions.size() && inst.Target >= 0 && (size_t)inst.Target < Instructions.size() && Instructions[inst.Target].Op == Opcode::Jump; hops++)
+				inst.Target = Instructions[inst.Target].Target;
+		}
+	}
+
+	if (!Statements.empty())
+	{
+		if (auto labels = dynamic_cast<LabelTableExpression*>(Statements.back()))
+		{
+			for (LabelEntry& entry : labels->Labels)
+				Labels.push_back({ entry.Name, findTarget(entry.Offset) });
+		}
+	}
+}
+
+bool Bytecode::IsConstant(Expression* expr)
+{
+	return dynamic_cast<IntConstExpression*>(expr) || dynamic_cast<FloatConstExpression*>(expr) || dynamic_cast<ByteConstExpression*>(expr) ||
+		dynamic_cast<IntConstByteExpression*>(expr) || dynamic_cast<IntZeroExpression*>(expr) || dynamic_cast<IntOneExpression*>(expr) ||
+		dynamic_cast<TrueExpression*>(expr) || dynamic_cast<FalseExpression*>(expr) || dynamic_cast<StringConstExpression*>(expr) ||
+		dynamic_cast<NameConstExpression*>(expr) || dynamic_cast<VectorConstExpression*>(expr) || dynamic_cast<RotationConstExpression*>(expr);
+}
+
+Expression* Bytecode::CreateConstant(const ExpressionValue& value, uint16_t offset)
+{
+	// Note: the constant replaces the folded expression at its code offset
+	switch (value.GetType())
+	{
+	case ExpressionValueType::ValueByte: { auto expr = Create<ByteConstExpression>(offset); expr->Value = value.ToByte(); return expr; }
+	case ExpressionValueType::ValueInt: { auto expr = Create<IntConstExpression>(offset); expr->Value = value.ToInt(); return expr; }
+	case ExpressionValueType::ValueBool: if (value.ToBool()) return Create<TrueExpression>(offset); else return Create<FalseExpression>(offset);
+	case ExpressionValueType::ValueFloat: { auto expr = Create<FloatConstExpression>(offset); expr->Value = value.ToFloat(); return expr; }
+	case ExpressionValueType::ValueString: { auto expr = Create<StringConstExpression>(offset); expr->Value = value.ToString(); return expr; }
+	case ExpressionValueType::ValueName: { auto expr = Create<NameConstExpression>(offset); expr->Value = value.ToName(); return expr; }
+	case ExpressionValueType::ValueVector: { auto expr = Create<VectorConstExpression>(offset); vec3 v = value.ToVector(); expr->X = v.x; expr->Y = v.y; expr->Z = v.z; return expr; }
+	case ExpressionValueType::ValueRotator: { auto expr = Create<RotationConstExpression>(offset); Rotator r = value.ToRotator(); expr->Pitch = r.Pitch; expr->Yaw = r.Yaw; expr->Roll = r.Roll; return expr; }
+	default: return nullptr;
+	}
+}
+
+Expression* Bytecode::FoldConstant(NativeFunctionExpression* expr, uint16_t offset)
+{
+	size_t index = expr->nativeindex;
+	if (index >= NativeFunctions::IntrinsicByIndex.size() || !NativeFunctions::IntrinsicByIndex[index] || expr->Args.size() > 2)
+		return expr;
+
+	ExpressionValue args[2];
+	for (size_t i = 0; i < expr->Args.size(); i++)
+	{
+		if (!IsConstant(expr->Args[i]))
+			return expr;
+		args[i] = ExpressionEvaluator::Eval(expr->Args[i], nullptr, nullptr, nullptr);
+	}
+
+	// Leave integer division by zero to fail at runtime, if the code is ever reached
+	if (NativeFunctions::FuncByIndex.size() > index && NativeFunctions::FuncByIndex[index] && NativeFunctions::FuncByIndex[index]->Name == "Divide_IntInt" && args[1].ToInt() == 0)
+		return expr;
+
+	Expression* constant = CreateConstant(NativeFunctions::IntrinsicByIndex[index](args), offset);
+	return constant ? constant : expr;
+}
+
+template<typename T>
+Expression* Bytecode::FoldConstant(T* expr, uint16_t offset)
+{
+	if (!IsConstant(expr->Value))
+		return expr;
+
+	Expression* constant = CreateConstant(ExpressionEvaluator::Eval(expr, nullptr, nullptr, nullptr), offset);
+	return constant ? constant : expr;
+}
+
+Expression* Bytecode::FindAppendValue(LetExpression* expr)
+{
+	// Only locals: the appended expression could otherwise change the variable before it is appended to
+	LocalVariableExpression* dest = dynamic_cast<LocalVariableExpression*>(expr->LeftSide);
+	NativeFunctionExpression* concat = dynamic_cast<NativeFunctionExpression*>(expr->RightSide);
+	if (!dest || !concat || concat->Args.size() != 2)
+		return nullptr;
+
+	size_t index = concat->nativeindex;
+	if (index >= NativeFunctions::FuncByIndex.size() || !NativeFunctions::FuncByIndex[index] || NativeFunctions::FuncByIndex[index]->Name != "Concat_StrStr")
+		return nullptr;
+
+	LocalVariableExpression* source = dynamic_cast<LocalVariableExpression*>(concat->Args[0]);
+	if (!source || source->Variable != dest->Variable)
+		return nullptr;
+
+	return concat->Args[1];
+}
+
+void Bytecode::FindTrackedProperty(LetExpression* expr)
+{
+	Expression* object = nullptr;
+	Expression* variable = expr->LeftSide;
+	if (ContextExpression* context = dynamic_cast<ContextExpression*>(variable))
+	{
+		object = context->ObjectExpr;
+		variable = context->ContextExpr;
+	}
+
+	// Locals and default variables never belong to an actor in the level
+	InstanceVariableExpression* instanceVariable = dynamic_cast<InstanceVariableExpression*>(variable);
+	if (!instanceVariable)
+		return;
+
+	expr->Tracked = instanceVariable->Tracked;
+	if (expr->Tracked != TrackedProperty::None)
+	{
+		expr->TrackedObject = object;
+		expr->TrackedVariable = instanceVariable;
+	}
 }
 
 Expression* Bytecode::ReadToken(BytecodeStream* stream, int depth)
@@ -30,7 +243,7 @@ Expression* Bytecode::ReadToken(BytecodeStream* stream, int depth)
 			expr->Args.push_back(ReadToken(stream, depth));
 		}
 		stream->ReadToken();
-		return expr;
+		return FoldConstant(expr, exproffset);
 	}
 	else if (token >= ExprToken::ExtendedNative)
 	{
@@ -42,7 +255,7 @@ Expression* Bytecode::ReadToken(BytecodeStream* stream, int depth)
 			expr->Args.push_back(ReadToken(stream, depth));
 		}
 		stream->ReadToken();
-		return expr;
+		return FoldConstant(expr, exproffset);
 	}
 	else if (token == ExprToken::VirtualFunction)
 	{
@@ -105,6 +318,7 @@ Expression* Bytecode::ReadToken(BytecodeStream* stream, int depth)
 		{
 			InstanceVariableExpression* expr = Create<InstanceVariableExpression>(exproffset);
 			expr->Variable = stream->ReadObject<UProperty>();
+			expr->Tracked = UActor::GetTrackedProperty(expr->Variable);
 			return expr;
 		}
 		case ExprToken::DefaultVariable:
@@ -185,6 +399,8 @@ Expression* Bytecode::ReadToken(BytecodeStream* stream, int depth)
 			LetExpression* expr = Create<LetExpression>(exproffset);
 			expr->LeftSide = ReadToken(stream, depth);
 			expr->RightSide = ReadToken(stream, depth);
+			expr->AppendValue = FindAppendValue(expr);
+			FindTrackedProperty(expr);
 			return expr;
 		}
 		case ExprToken::DynArrayElement:
@@ -385,39 +601,39 @@ Expression* Bytecode::ReadToken(BytecodeStream* stream, int depth)
 		}
 		case ExprToken::IteratorPop: { return Create<IteratorPopExpression>(exproffset); }
 		case ExprToken::IteratorNext: { return Create<IteratorNextExpression>(exproffset); }
-		case ExprToken::RotatorToVector: { auto expr = Create<RotatorToVectorExpression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
-		case ExprToken::ByteToInt: { auto expr = Create<ByteToIntExpression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
-		case ExprToken::ByteToBool: { auto expr = Create<ByteToBoolExpression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
-		case ExprToken::ByteToFloat: { auto expr = Create<ByteToFloatExpression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
-		case ExprToken::IntToByte: { auto expr = Create<IntToByteExpression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
-		case ExprToken::IntToBool: { auto expr = Create<IntToBoolExpression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
-		case ExprToken::IntToFloat: { auto expr = Create<IntToFloatExpression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
-		case ExprToken::BoolToByte: { auto expr = Create<BoolToByteExpression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
-		case ExprToken::BoolToInt: { auto expr = Create<BoolToIntExpression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
-		case ExprToken::BoolToFloat: { auto expr = Create<BoolToFloatExpression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
-		case ExprToken::FloatToByte: { auto expr = Create<FloatToByteExpression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
-		case ExprToken::FloatToInt: { auto expr = Create<FloatToIntExpression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
-		case ExprToken::FloatToBool: { auto expr = Create<FloatToBoolExpression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
+		case ExprToken::RotatorToVector: { auto expr = Create<RotatorToVectorExpression>(exproffset); expr->Value = ReadToken(stream, depth); return FoldConstant(expr, exproffset); }
+		case ExprToken::ByteToInt: { auto expr = Create<ByteToIntExpression>(exproffset); expr->Value = ReadToken(stream, depth); return FoldConstant(expr, exproffset); }
+		case ExprToken::ByteToBool: { auto expr = Create<ByteToBoolExpression>(exproffset); expr->Value = ReadToken(stream, depth); return FoldConstant(expr, exproffset); }
+		case ExprToken::ByteToFloat: { auto expr = Create<ByteToFloatExpression>(exproffset); expr->Value = ReadToken(stream, depth); return FoldConstant(expr, exproffset); }
+		case ExprToken::IntToByte: { auto expr = Create<IntToByteExpression>(exproffset); expr->Value = ReadToken(stream, depth); return FoldConstant(expr, exproffset); }
+		case ExprToken::IntToBool: { auto expr = Create<IntToBoolExpression>(exproffset); expr->Value = ReadToken(stream, depth); return FoldConstant(expr, exproffset); }
+		case ExprToken::IntToFloat: { auto expr = Create<IntToFloatExpression>(exproffset); expr->Value = ReadToken(stream, depth); return FoldConstant(expr, exproffset); }
+		case ExprToken::BoolToByte: { auto expr = Create<BoolToByteExpression>(exproffset); expr->Value = ReadToken(stream, depth); return FoldConstant(expr, exproffset); }
+		case ExprToken::BoolToInt: { auto expr = Create<BoolToIntExpression>(exproffset); expr->Value = ReadToken(stream, depth); return FoldConstant(expr, exproffset); }
+		case ExprToken::BoolToFloat: { auto expr = Create<BoolToFloatExpression>(exproffset); expr->Value = ReadToken(stream, depth); return FoldConstant(expr, exproffset); }
+		case ExprToken::FloatToByte: { auto expr = Create<FloatToByteExpression>(exproffset); expr->Value = ReadToken(stream, depth); return FoldConstant(expr, exproffset); }
+		case ExprToken::FloatToInt: { auto expr = Create<FloatToIntExpression>(exproffset); expr->Value = ReadToken(stream, depth); return FoldConstant(expr, exproffset); }
+		case ExprToken::FloatToBool: { auto expr = Create<FloatToBoolExpression>(exproffset); expr->Value = ReadToken(stream, depth); return FoldConstant(expr, exproffset); }
 		case ExprToken::Unknown0x46: { auto expr = Create<Unknown0x46Expression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
-		case ExprToken::ObjectToBool: { auto expr = Create<ObjectToBoolExpression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
-		case ExprToken::NameToBool: { auto expr = Create<NameToBoolExpression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
-		case ExprToken::StringToByte: { auto expr = Create<StringToByteExpression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
-		case ExprToken::StringToInt: { auto expr = Create<StringToIntExpression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
-		case ExprToken::StringToBool: { auto expr = Create<StringToBoolExpression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
-		case ExprToken::StringToFloat: { auto expr = Create<StringToFloatExpression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
-		case ExprToken::StringToVector: { auto expr = Create<StringToVectorExpression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
-		case ExprToken::StringToRotator: { auto expr = Create<StringToRotatorExpression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
-		case ExprToken::VectorToBool: { auto expr = Create<VectorToBoolExpression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
-		case ExprToken::VectorToRotator: { auto expr = Create<VectorToRotatorExpression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
-		case ExprToken::RotatorToBool: { auto expr = Create<RotatorToBoolExpression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
-		case ExprToken::ByteToString: { auto expr = Create<ByteToStringExpression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
-		case ExprToken::IntToString: { auto expr = Create<IntToStringExpression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
-		case ExprToken::BoolToString: { auto expr = Create<BoolToStringExpression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
-		case ExprToken::FloatToString: { auto expr = Create<FloatToStringExpression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
-		case ExprToken::ObjectToString: { auto expr = Create<ObjectToStringExpression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
-		case ExprToken::NameToString: { auto expr = Create<NameToStringExpression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
-		case ExprToken::VectorToString: { auto expr = Create<VectorToStringExpression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
-		case ExprToken::RotatorToString: { auto expr = Create<RotatorToStringExpression>(exproffset); expr->Value = ReadToken(stream, depth); return expr; }
+		case ExprToken::ObjectToBool: { auto expr = Create<ObjectToBoolExpression>(exproffset); expr->Value = ReadToken(stream, depth); return FoldConstant(expr, exproffset); }
+		case ExprToken::NameToBool: { auto expr = Create<NameToBoolExpression>(exproffset); expr->Value = ReadToken(stream, depth); return FoldConstant(expr, exproffset); }
+		case ExprToken::StringToByte: { auto expr = Create<StringToByteExpression>(exproffset); expr->Value = ReadToken(stream, depth); return FoldConstant(expr, exproffset); }
+		case ExprToken::StringToInt: { auto expr = Create<StringToIntExpression>(exproffset); expr->Value = ReadToken(stream, depth); return FoldConstant(expr, exproffset); }
+		case ExprToken::StringToBool: { auto expr = Create<StringToBoolExpression>(exproffset); expr->Value = ReadToken(stream, depth); return FoldConstant(expr, exproffset); }
+		case ExprToken::StringToFloat: { auto expr = Create<StringToFloatExpression>(exproffset); expr->Value = ReadToken(stream, depth); return FoldConstant(expr, exproffset); }
+		case ExprToken::StringToVector: { auto expr = Create<StringToVectorExpression>(exproffset); expr->Value = ReadToken(stream, depth); return FoldConstant(expr, exproffset); }
+		case ExprToken::StringToRotator: { auto expr = Create<StringToRotatorExpression>(exproffset); expr->Value = ReadToken(stream, depth); return FoldConstant(expr, exproffset); }
+		case ExprToken::VectorToBool: { auto expr = Create<VectorToBoolExpression>(exproffset); expr->Value = ReadToken(stream, depth); return FoldConstant(expr, exproffset); }
+		case ExprToken::VectorToRotator: { auto expr = Create<VectorToRotatorExpression>(exproffset); expr->Value = ReadToken(stream, depth); return FoldConstant(expr, exproffset); }
+		case ExprToken::RotatorToBool: { auto expr = Create<RotatorToBoolExpression>(exproffset); expr->Value = ReadToken(stream, depth); return FoldConstant(expr, exproffset); }
+		case ExprToken::ByteToString: { auto expr = Create<ByteToStringExpression>(exproffset); expr->Value = ReadToken(stream, depth); return FoldConstant(expr, exproffset); }
+		case ExprToken::IntToString: { auto expr = Create<IntToStringExpression>(exproffset); expr->Value = ReadToken(stream, depth); return FoldConstant(expr, exproffset); }
+		case ExprToken::BoolToString: { auto expr = Create<BoolToStringExpression>(exproffset); expr->Value = ReadToken(stream, depth); return FoldConstant(expr, exproffset); }
+		case ExprToken::FloatToString: { auto expr = Create<FloatToStringExpression>(exproffset); expr->Value = ReadToken(stream, depth); return FoldConstant(expr, exproffset); }
+		case ExprToken::ObjectToString: { auto expr = Create<ObjectToStringExpression>(exproffset); expr->Value = ReadToken(stream, depth); return FoldConstant(expr, exproffset); }
+		case ExprToken::NameToString: { auto expr = Create<NameToStringExpression>(exproffset); expr->Value = ReadToken(stream, depth); return FoldConstant(expr, exproffset); }
+		case ExprToken::VectorToString: { auto expr = Create<VectorToStringExpression>(exproffset); expr->Value = ReadToken(stream, depth); return FoldConstant(expr, exproffset); }
+		case ExprToken::RotatorToString: { auto expr = Create<RotatorToStringExpression>(exproffset); expr->Value = ReadToken(stream, depth); return FoldConstant(expr, exproffset); }
 		default:
 			throw std::runtime_error("Unknown script bytecode token encountered");
 		}
@@ -4,8 +4,71 @@
 #include "UObject/UProperty.h"
 #include "Package/Package.h"
 #include "Expression.h"
+#include "CompiledScript.h"
 
 class BytecodeStream;
+class ExpressionValue;
+
+enum class Opcode : uint8_t
+{
+	Eval,
+	Nothing,
+	Jump,
+	JumpIfNot,
+	Switch,
+	Case,
+	GotoLabel,
+	Return,
+	Stop,
+	Iterator,
+	IteratorNext,
+	IteratorPop
+};
+
+// One entry per statement. Control flow is lowered out of the expression tree with its jump target already resolved to a statement index.
+struct Instruction
+{
+	Opcode Op = Opcode::Eval;
+	int Target = -1;
+	Expression* Operand = nullptr;
+};
+
+// Bump allocator keeping the expression nodes of a function contiguous in parse order
+class ExpressionArena
+{
+public:
+	ExpressionArena(size_t blockSize) : BlockSize(blockSize) { }
+	~ExpressionArena();
+
+	template<typename T>
+	T* Create()
+	{
+		T* obj = new(Alloc(sizeof(T), alignof(T))) T();
+		Nodes.push_back(obj);
+		return obj;
+	}
+
+private:
+	void* Alloc(size_t size, size_t alignment)
+	{
+		size_t offset = (CurrentOffset + alignment - 1) & ~(alignment - 1);
+		if (Blocks.empty() || offset + size > CurrentSize)
+			return AllocBlock(size);
+		CurrentOffset = offset + size;
+		return Blocks.back().get() + offset;
+	}
+
+	void* AllocBlock(size_t size);
+
+	size_t BlockSize;
+	size_t CurrentOffset = 0;
+	size_t CurrentSize = 0;
+	std::vector<std::unique_ptr<uint8_t[]>> Blocks;
+	std::vector<Expression*> Nodes;
+
+	ExpressionArena(const ExpressionArena&) = delete;
+	ExpressionArena& operator=(const ExpressionArena&) = delete;
+};
 
 class Bytecode
 {
@@ -17,36 +80,47 @@ public:
 		return OffsetToExpression.find(offset)->second->StatementIndex;
 	}
 
-	int FindLabelIndex(const NameString& label)
+	int FindLabelIndex(const NameString& label) const
 	{
-		LabelTableExpression* labels = dynamic_cast<LabelTableExpression*>(Statements.back());
-		if (labels)
+		for (const auto& entry : Labels)
 		{
-			for (LabelEntry& entry : labels->Labels)
-			{
-				if (entry.Name == label)
-					return FindStatementIndex(entry.Offset);
-			}
+			if (entry.first == label)
+				return entry.second;
 		}
 		return -1;
 	}
 
 	std::vector<Expression*> Statements;
+	std::vector<Instruction> Instructions;
+	std::vector<std::pair<NameString, int>> Labels;
+
+	uint64_t Hash = 0; // Identifies the bytecode and variable layout for CompiledScript
+	CompiledScriptFunc Compiled = nullptr;
 
 private:
 	Expression* ReadToken(BytecodeStream* stream, int depth);
+	void Compile();
+
+	static bool IsConstant(Expression* expr);
+	Expression* CreateConstant(const ExpressionValue& value, uint16_t offset);
+	Expression* FoldConstant(NativeFunctionExpression* expr, uint16_t offset);
+	template<typename T> Expression* FoldConstant(T* expr, uint16_t offset);
+	static Expression* FindAppendValue(LetExpression* expr);
+	static void FindTrackedProperty(LetExpression* expr);
 
 	template<typename T>
 	T* Create(uint16_t offset)
 	{
-		Allocations.push_back(std::make_unique<T>());
-		T* obj = static_cast<T*>(Allocations.back().get());
+		T* obj = Arena.Create<T>();
 		OffsetToExpression[offset] = obj;
 		return obj;
 	}
 
 	std::map<uint16_t, Expression*> OffsetToExpression;
-	std::vector<std::unique_ptr<Expression>> Allocations;
+	ExpressionArena Arena;
+
+	Bytecode(const Bytecode&) = delete;
+	Bytecode& operator=(const Bytecode&) = delete;
 };
 
 class BytecodeStream
@@ -0,0 +1,86 @@
+
+#include "Precomp.h"
+#include "CompiledScript.h"
+#include "UObject/UClass.h"
+#include "UObject/UProperty.h"
+#include "Package/Package.h"
+
+void CompiledScript::Register(const char* name, uint64_t hash, size_t instructionCount, CompiledScriptFunc func)
+{
+	Entry entry;
+	entry.Hash = hash;
+	entry.InstructionCount = instructionCount;
+	entry.Func = func;
+	GetEntries()[name] = entry;
+}
+
+CompiledScriptFunc CompiledScript::Find(Package* package, UStruct* func, uint64_t hash, size_t instructionCount)
+{
+	auto& entries = GetEntries();
+	if (entries.empty() || !package)
+		return nullptr;
+
+	// The generated code bakes in the expression tree and property offsets, so it is only used for the bytecode it was translated from
+	auto it = entries.find(GetName(package, func));
+	if (it == entries.end() || it->second.Hash != hash || it->second.InstructionCount != instructionCount)
+		return nullptr;
+	return it->second.Func;
+}
+
+std::string CompiledScript::GetName(Package* package, UStruct* func)
+{
+	std::string name = func->Name.ToString();
+	for (UStruct* parent = func->StructParent; parent != nullptr; parent = parent->StructParent)
+		name = parent->Name.ToString() + "." + name;
+	return package->GetPackageName().ToString() + "." + name;
+}
+
+uint64_t CompiledScript::GetHash(UStruct* func, const std::vector<uint8_t>& bytecode)
+{
+	// 64-bit FNV-1a of the decoder version, the bytecode and the layout of the locals, the enclosing state and class, and everything they derive from
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	auto add = [&](uint64_t value)
+	{
+		for (int i = 0; i < 8; i++)
+		{
+			hash ^= (value >> (i * 8)) & 0xff;
+			hash *= 0x100000001b3ULL;
+		}
+	};
+
+	add(DecoderVersion);
+
+	for (uint8_t c : bytecode)
+	{
+		hash ^= c;
+		hash *= 0x100000001b3ULL;
+	}
+
+	for (UStruct* parent = func; parent != nullptr; parent = parent->StructParent)
+	{
+		for (UStruct* s = parent; s != nullptr; s = s->BaseStruct)
+		{
+			add(s->StructSize);
+			for (UProperty* prop : s->Properties)
+			{
+				add(prop->DataOffset);
+				add(prop->ArrayDimension);
+				add((uint64_t)prop->ValueType);
+			}
+		}
+	}
+	return hash;
+}
+
+bool CompiledScript::IsActive()
+{
+	return Translating || !GetEntries().empty();
+}
+
+bool CompiledScript::Translating = false;
+
+std::unordered_map<std::string, CompiledScript::Entry>& CompiledScript::GetEntries()
+{
+	static std::unordered_map<std::string, Entry> entries;
+	return entries;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <unordered_map>
+
+class Frame;
+class Package;
+class UStruct;
+class ExpressionValue;
+
+// Script code translated ahead of time to C++ by ScriptTranslator.
+// Runs the statements of a frame starting at its StatementIndex. Returns false if the frame switched to other code (GotoState) and the
+// interpreter has to continue from there, or true when the frame returned, stopped or got suspended by a latent function.
+typedef bool(*CompiledScriptFunc)(Frame* frame, ExpressionValue& result);
+
+class CompiledScript
+{
+public:
+	// Bump when Bytecode decodes or lowers the script differently (constant folding, jump collapsing, Let classification, ..).
+	// The generated code refers to the statement indexes and operands it produces.
+	enum { DecoderVersion = 2 };
+
+	static void Register(const char* name, uint64_t hash, size_t instructionCount, CompiledScriptFunc func);
+
+	// Finds the translated code for a function or state, or nullptr if there is none for this exact bytecode
+	static CompiledScriptFunc Find(Package* package, UStruct* func, uint64_t hash, size_t instructionCount);
+
+	static std::string GetName(Package* package, UStruct* func);
+	static uint64_t GetHash(UStruct* func, const std::vector<uint8_t>& bytecode);
+
+	// Bytecode only needs hashing if there is translated code to match it against, or when translating it
+	static bool IsActive();
+	static bool Translating;
+
+private:
+	struct Entry
+	{
+		uint64_t Hash = 0;
+		size_t InstructionCount = 0;
+		CompiledScriptFunc Func = nullptr;
+	};
+
+	static std::unordered_map<std::string, Entry>& GetEntries();
+};
+
+// Used by the generated code to register its functions during static initialization
+class CompiledScriptRegistration
+{
+public:
+	CompiledScriptRegistration(const char* name, uint64_t hash, size_t instructionCount, CompiledScriptFunc func) { CompiledScript::Register(name, hash, instructionCount, func); }
+};
+
+// Variable access for the generated code
+template<typename T>
+T& CompiledScriptVar(void* data, size_t offset)
+{
+	return *reinterpret_cast<T*>(static_cast<uint8_t*>(data) + offset);
+}
@@ -7,6 +7,8 @@ class UObject;
 class UClass;
 class UFunction;
 class UProperty;
+class UStruct;
+enum class TrackedProperty : uint8_t;
 
 class Expression
 {
@@ -15,6 +17,7 @@ public:
 	virtual void Visit(ExpressionVisitor* visitor) = 0;
 
 	int StatementIndex = -1;
+	bool Breakpoint = false;
 };
 
 class LocalVariableExpression : public Expression
@@ -31,6 +34,7 @@ public:
 	void Visit(ExpressionVisitor* visitor) override { visitor->Expr(this); }
 
 	UProperty* Variable = nullptr;
+	TrackedProperty Tracked = {};
 };
 
 class DefaultVariableExpression : public Expression
@@ -142,6 +146,13 @@ public:
 
 	Expression* LeftSide = nullptr;
 	Expression* RightSide = nullptr;
+	Expression* AppendValue = nullptr; // Set when the statement is 's = s $ x' for a local string s
+
+	// Set when assigning an actor variable the level keeps state for. The left side is then also available split into
+	// the object ('Other' in 'Other.Var = x', or nullptr for the current context) and the variable itself.
+	TrackedProperty Tracked = {};
+	Expression* TrackedObject = nullptr;
+	InstanceVariableExpression* TrackedVariable = nullptr;
 };
 
 class DynArrayElementExpression : public Expression
@@ -705,6 +716,17 @@ public:
 
 	NameString Name;
 	std::vector<Expression*> Args;
+
+	// Inline cache of resolved call targets. The active state is part of the key so that GotoState/SetState never sees a stale entry.
+	struct CacheEntry
+	{
+		UClass* Class = nullptr;
+		UStruct* State = nullptr;
+		UFunction* Func = nullptr;
+	};
+	enum { CacheSize = 4 };
+	CacheEntry Cache[CacheSize];
+	int NextCacheEntry = 0;
 };
 
 class FinalFunctionExpression : public Expression
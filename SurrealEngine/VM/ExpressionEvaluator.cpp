@@ -5,25 +5,35 @@
 #include "Bytecode.h"
 #include "Frame.h"
 #include "NativeFunc.h"
+#include "ScriptProfiler.h"
 #include "Engine.h"
 #include "Package/PackageManager.h"
+#include "UObject/ULevel.h"
+#include "UObject/UActor.h"
 
-ExpressionEvalResult ExpressionEvaluator::Eval(Expression* expr, UObject* self, UObject* context, void* localVariables)
+ExpressionValue ExpressionEvaluator::Eval(Expression* expr, UObject* self, UObject* context, void* localVariables)
+{
+	if (Frame::DebuggerActive || expr->Breakpoint)
+		return EvalDebug(expr, self, context, localVariables);
+
+	ExpressionEvaluator evaluator;
+	evaluator.Self = self;
+	evaluator.Context = context;
+	evaluator.LocalVariables = localVariables;
+	expr->Visit(&evaluator);
+	return std::move(evaluator.Result);
+}
+
+ExpressionValue ExpressionEvaluator::EvalDebug(Expression* expr, UObject* self, UObject* context, void* localVariables)
 {
 	auto oldExpr = Frame::StepExpression;
 	Frame::StepExpression = expr;
 
-	for (Expression* breakpoint : Frame::Breakpoints)
-	{
-		if (breakpoint == expr)
-		{
-			Frame::Break();
-		}
-	}
+	if (expr->Breakpoint)
+		Frame::Break();
 
 	ExpressionEvaluator evaluator;
 	evaluator.Self = self;
-	if (context == (UObject*)0xccccccccccccccccULL) DebugBreak();
 	evaluator.Context = context;
 	evaluator.LocalVariables = localVariables;
 	expr->Visit(&evaluator);
@@ -33,60 +43,60 @@ ExpressionEvalResult ExpressionEvaluator::Eval(Expression* expr, UObject* self,
 
 void ExpressionEvaluator::Expr(LocalVariableExpression* expr)
 {
-	Result.Value = ExpressionValue::Variable(LocalVariables, expr->Variable);
+	Result = ExpressionValue::Variable(LocalVariables, expr->Variable);
 }
 
 void ExpressionEvaluator::Expr(InstanceVariableExpression* expr)
 {
-	Result.Value = ExpressionValue::Variable(Context->PropertyData.Data, expr->Variable);
+	if (expr->Tracked == TrackedProperty::TimerCounter)
+	{
+		if (UActor* actor = UObject::TryCast<UActor>(Context))
+		{
+			if (actor->XLevel())
+				actor->XLevel()->UpdateTimerCounter(actor);
+		}
+	}
+	Result = ExpressionValue::Variable(Context->PropertyData.Data, expr->Variable);
 }
 
 void ExpressionEvaluator::Expr(DefaultVariableExpression* expr)
 {
-	if (dynamic_cast<UClass*>(Context))
-		Result.Value = ExpressionValue::Variable(Context->PropertyData.Data, expr->Variable);
+	if (UObject::TryCast<UClass>(Context))
+		Result = ExpressionValue::Variable(Context->PropertyData.Data, expr->Variable);
 	else
-		Result.Value = ExpressionValue::Variable(Context->Class->GetDefaultObject()->PropertyData.Data, expr->Variable);
+		Result = ExpressionValue::Variable(Context->Class->GetDefaultObject()->PropertyData.Data, expr->Variable);
 }
 
+// Control flow statements are lowered into Bytecode::Instructions and executed by Frame::Run
+
 void ExpressionEvaluator::Expr(ReturnExpression* expr)
 {
-	if (expr->Value)
-		Result.Value = Eval(expr->Value).Value;
-	else
-		Result.Value = ExpressionValue::NothingValue();
-	Result.Result = StatementResult::Return;
+	Frame::ThrowException("Return expression encountered outside a statement");
 }
 
 void ExpressionEvaluator::Expr(SwitchExpression* expr)
 {
-	Result.Value = Eval(expr->Condition).Value;
-	Result.Result = StatementResult::Switch;
+	Frame::ThrowException("Switch expression encountered outside a statement");
 }
 
 void ExpressionEvaluator::Expr(JumpExpression* expr)
 {
-	Result.Result = StatementResult::Jump;
-	Result.JumpAddress = expr->Offset;
+	Frame::ThrowException("Jump expression encountered outside a statement");
 }
 
 void ExpressionEvaluator::Expr(JumpIfNotExpression* expr)
 {
-	if (!Eval(expr->Condition).Value.ToBool())
-	{
-		Result.Result = StatementResult::Jump;
-		Result.JumpAddress = expr->Offset;
-	}
+	Frame::ThrowException("JumpIfNot expression encountered outside a statement");
 }
 
 void ExpressionEvaluator::Expr(StopExpression* expr)
 {
-	Result.Result = StatementResult::Stop;
+	Frame::ThrowException("Stop expression encountered outside a statement");
 }
 
 void ExpressionEvaluator::Expr(AssertExpression* expr)
 {
-	if (!Eval(expr->Condition).Value.ToBool())
+	if (!Eval(expr->Condition).ToBool())
 	{
 		Frame::ThrowException("Script assert failed for " + Self->Name.ToString() + " line " + std::to_string(expr->Line));
 	}
@@ -94,12 +104,12 @@ void ExpressionEvaluator::Expr(AssertExpression* expr)
 
 void ExpressionEvaluator::Expr(CaseExpression* expr)
 {
-	Result.Value = ExpressionValue::NothingValue();
+	Result = ExpressionValue::NothingValue();
 }
 
 void ExpressionEvaluator::Expr(NothingExpression* expr)
 {
-	Result.Value = ExpressionValue::NothingValue();
+	Result = ExpressionValue::NothingValue();
 }
 
 void ExpressionEvaluator::Expr(LabelTableExpression* expr)
@@ -109,30 +119,69 @@ void ExpressionEvaluator::Expr(LabelTableExpression* expr)
 
 void ExpressionEvaluator::Expr(GotoLabelExpression* expr)
 {
-	Result.Result = StatementResult::GotoLabel;
-	Result.Label = Eval(expr->Value).Value.ToName();
+	Frame::ThrowException("GotoLabel expression encountered outside a statement");
 }
 
 void ExpressionEvaluator::Expr(EatStringExpression* expr)
 {
 	Eval(expr->Value);
-	Result.Value = ExpressionValue::NothingValue();
+	Result = ExpressionValue::NothingValue();
 }
 
 void ExpressionEvaluator::Expr(LetExpression* expr)
 {
-	ExpressionValue lvalue = Eval(expr->LeftSide).Value;
-	ExpressionValue rvalue = Eval(expr->RightSide).Value;
+	if (expr->Tracked != TrackedProperty::None)
+	{
+		LetTracked(expr);
+		return;
+	}
+
+	ExpressionValue lvalue = Eval(expr->LeftSide);
+	if (expr->AppendValue)
+	{
+		// Append to the local string in place rather than building a copy of it
+		ExpressionValue value = Eval(expr->AppendValue);
+		lvalue.ToType<std::string&>().append(value.ToString());
+		Result = std::move(lvalue);
+		return;
+	}
+
+	ExpressionValue rvalue = Eval(expr->RightSide);
 	lvalue.Store(rvalue);
-	Result.Value = std::move(lvalue);
+	Result = std::move(lvalue);
+}
+
+void ExpressionEvaluator::LetTracked(LetExpression* expr)
+{
+	// The left side was split when decoding the bytecode, so that the actor being assigned to is known
+	UObject* object = Context;
+	if (expr->TrackedObject)
+	{
+		if (expr->LeftSide->Breakpoint)
+			Frame::Break();
+
+		object = Eval(expr->TrackedObject).ToObject();
+		if (!object)
+		{
+			Frame::ThrowException("Object reference not set to an instance of an object");
+			return;
+		}
+	}
+
+	ExpressionValue lvalue = Eval(expr->TrackedVariable, Self, object, LocalVariables);
+	ExpressionValue rvalue = Eval(expr->RightSide);
+	lvalue.Store(rvalue);
+	if (UActor* actor = UObject::TryCast<UActor>(object))
+		actor->TrackedPropertyChanged(expr->Tracked);
+	Result = std::move(lvalue);
 }
 
 void ExpressionEvaluator::Expr(LetBoolExpression* expr)
 {
-	ExpressionValue lvalue = Eval(expr->LeftSide).Value;
-	ExpressionValue rvalue = Eval(expr->RightSide).Value;
+	ExpressionValue lvalue = Eval(expr->LeftSide);
+	ExpressionValue rvalue = Eval(expr->RightSide);
 	lvalue.Store(rvalue);
-	Result.Value = std::move(lvalue);
+	Result = std::move(lvalue);
 }
 
 void ExpressionEvaluator::Expr(DynArrayElementExpression* expr)
@@ -142,10 +191,10 @@ void ExpressionEvaluator::Expr(DynArrayElementExpression* expr)
 
 void ExpressionEvaluator::Expr(NewExpression* expr)
 {
-	ExpressionValue outer = Eval(expr->ParentExpr).Value;
-	ExpressionValue name = Eval(expr->NameExpr).Value;
-	ExpressionValue flags = Eval(expr->FlagsExpr).Value;
-	UClass* cls = UObject::Cast<UClass>(Eval(expr->ClassExpr).Value.ToObject());
+	ExpressionValue outer = Eval(expr->ParentExpr);
+	ExpressionValue name = Eval(expr->NameExpr);
+	ExpressionValue flags = Eval(expr->FlagsExpr);
+	UClass* cls = UObject::Cast<UClass>(Eval(expr->ClassExpr).ToObject());
 
 	// To do: package needs to be grabbed from outer, or the "transient package" if it is None, a virtual package for runtime objects
 	Package* package = engine->packages->GetPackage("Engine");
@@ -159,13 +208,13 @@ void ExpressionEvaluator::Expr(NewExpression* expr)
 	if (outer.GetType() != ExpressionValueType::Nothing)
 		newObj->Outer() = outer.ToObject();
 
-	Result.Value = ExpressionValue::ObjectValue(newObj);
+	Result = ExpressionValue::ObjectValue(newObj);
 }
 
 void ExpressionEvaluator::Expr(ClassContextExpression* expr)
 {
-	ExpressionValue object = Eval(expr->ObjectExpr).Value;
-	UClass* cls = dynamic_cast<UClass*>(object.ToObject());
+	ExpressionValue object = Eval(expr->ObjectExpr);
+	UClass* cls = UObject::TryCast<UClass>(object.ToObject());
 	if (cls)
 	{
 		Result = Eval(expr->ContextExpr, Self, cls->GetDefaultObject(), LocalVariables);
@@ -178,20 +227,14 @@ void ExpressionEvaluator::Expr(ClassContextExpression* expr)
 
 void ExpressionEvaluator::Expr(MetaCastExpression* expr)
 {
-	UObject* value = Eval(expr->Value).Value.ToObject();
+	UObject* value = Eval(expr->Value).ToObject();
 	if (value && value != expr->Class)
 	{
 		UClass* cls = UObject::TryCast<UClass>(value);
-		while (cls)
-		{
-			if (cls == expr->Class)
-				break;
-			cls = static_cast<UClass*>(cls->BaseStruct);
-		}
-		if (!cls)
+		if (!cls || !cls->IsChildOf(expr->Class))
 			value = nullptr;
 	}
-	Result.Value = ExpressionValue::ObjectValue(value);
+	Result = ExpressionValue::ObjectValue(value);
 }
 
 void ExpressionEvaluator::Expr(Unknown0x15Expression* expr)
@@ -201,7 +244,7 @@ void ExpressionEvaluator::Expr(Unknown0x15Expression* expr)
 
 void ExpressionEvaluator::Expr(SelfExpression* expr)
 {
-	Result.Value = ExpressionValue::ObjectValue(Self);
+	Result = ExpressionValue::ObjectValue(Self);
 }
 
 void ExpressionEvaluator::Expr(SkipExpression* expr)
@@ -211,7 +254,7 @@ void ExpressionEvaluator::Expr(SkipExpression* expr)
 
 void ExpressionEvaluator::Expr(ContextExpression* expr)
 {
-	auto value = Eval(expr->ObjectExpr).Value;
+	auto value = Eval(expr->ObjectExpr);
 	UObject* context = value.ToObject();
 	if (context)
 	{
@@ -225,11 +268,11 @@ void ExpressionEvaluator::Expr(ContextExpression* expr)
 
 void ExpressionEvaluator::Expr(ArrayElementExpression* expr)
 {
-	int index = Eval(expr->Index).Value.ToInt();
-	auto arrayval = Eval(expr->Array).Value;
+	int index = Eval(expr->Index).ToInt();
+	auto arrayval = Eval(expr->Array);
 	if (arrayval.IsVariable())
 	{
-		Result.Value = arrayval.ItemAt(index);
+		Result = arrayval.ItemAt(index);
 	}
 	else
 	{
@@ -239,62 +282,62 @@ void ExpressionEvaluator::Expr(ArrayElementExpression* expr)
 
 void ExpressionEvaluator::Expr(IntConstExpression* expr)
 {
-	Result.Value = ExpressionValue::IntValue(expr->Value);
+	Result = ExpressionValue::IntValue(expr->Value);
 }
 
 void ExpressionEvaluator::Expr(FloatConstExpression* expr)
 {
-	Result.Value = ExpressionValue::FloatValue(expr->Value);
+	Result = ExpressionValue::FloatValue(expr->Value);
 }
 
 void ExpressionEvaluator::Expr(StringConstExpression* expr)
 {
-	Result.Value = ExpressionValue::StringValue(expr->Value);
+	Result = ExpressionValue::StringValue(expr->Value);
 }
 
 void ExpressionEvaluator::Expr(ObjectConstExpression* expr)
 {
-	Result.Value = ExpressionValue::ObjectValue(expr->Object);
+	Result = ExpressionValue::ObjectValue(expr->Object);
 }
 
 void ExpressionEvaluator::Expr(NameConstExpression* expr)
 {
-	Result.Value = ExpressionValue::NameValue(expr->Value);
+	Result = ExpressionValue::NameValue(expr->Value);
 }
 
 void ExpressionEvaluator::Expr(RotationConstExpression* expr)
 {
-	Result.Value = ExpressionValue::RotatorValue({ expr->Pitch, expr->Yaw, expr->Roll });
+	Result = ExpressionValue::RotatorValue({ expr->Pitch, expr->Yaw, expr->Roll });
 }
 
 void ExpressionEvaluator::Expr(VectorConstExpression* expr)
 {
-	Result.Value = ExpressionValue::VectorValue({ expr->X, expr->Y, expr->Z });
+	Result = ExpressionValue::VectorValue({ expr->X, expr->Y, expr->Z });
 }
 
 void ExpressionEvaluator::Expr(ByteConstExpression* expr)
 {
-	Result.Value = ExpressionValue::ByteValue(expr->Value);
+	Result = ExpressionValue::ByteValue(expr->Value);
 }
 
 void ExpressionEvaluator::Expr(IntZeroExpression* expr)
 {
-	Result.Value = ExpressionValue::IntValue(0);
+	Result = ExpressionValue::IntValue(0);
 }
 
 void ExpressionEvaluator::Expr(IntOneExpression* expr)
 {
-	Result.Value = ExpressionValue::IntValue(1);
+	Result = ExpressionValue::IntValue(1);
 }
 
 void ExpressionEvaluator::Expr(TrueExpression* expr)
 {
-	Result.Value = ExpressionValue::BoolValue(true);
+	Result = ExpressionValue::BoolValue(true);
 }
 
 void ExpressionEvaluator::Expr(FalseExpression* expr)
 {
-	Result.Value = ExpressionValue::BoolValue(false);
+	Result = ExpressionValue::BoolValue(false);
 }
 
 void ExpressionEvaluator::Expr(NativeParmExpression* expr)
@@ -304,7 +347,7 @@ void ExpressionEvaluator::Expr(NativeParmExpression* expr)
 
 void ExpressionEvaluator::Expr(NoObjectExpression* expr)
 {
-	Result.Value = ExpressionValue::ObjectValue(nullptr);
+	Result = ExpressionValue::ObjectValue(nullptr);
 }
 
 void ExpressionEvaluator::Expr(Unknown0x2bExpression* expr)
@@ -314,58 +357,55 @@ void ExpressionEvaluator::Expr(Unknown0x2bExpression* expr)
 
 void ExpressionEvaluator::Expr(IntConstByteExpression* expr)
 {
-	Result.Value = ExpressionValue::ByteValue(expr->Value);
+	Result = ExpressionValue::ByteValue(expr->Value);
 }
 
 void ExpressionEvaluator::Expr(BoolVariableExpression* expr)
 {
-	Result.Value = Eval(expr->Variable).Value;
+	Result = Eval(expr->Variable);
 }
 
 void ExpressionEvaluator::Expr(DynamicCastExpression* expr)
 {
-	UObject* value = Eval(expr->Value).Value.ToObject();
-	if (value && !value->IsA(expr->Class->Name))
+	UObject* value = Eval(expr->Value).ToObject();
+	if (value && !value->IsA(expr->Class))
 		value = nullptr;
-	Result.Value = ExpressionValue::ObjectValue(value);
+	Result = ExpressionValue::ObjectValue(value);
 }
 
 void ExpressionEvaluator::Expr(IteratorExpression* expr)
 {
-	Eval(expr->Value);
-	Result.Result = StatementResult::Iterator;
-	Result.Iter = std::move(Frame::CreatedIterator);
-	Result.JumpAddress = expr->Offset;
+	Frame::ThrowException("Iterator expression encountered outside a statement");
 }
 
 void ExpressionEvaluator::Expr(IteratorPopExpression* expr)
 {
-	Result.Result = StatementResult::IteratorPop;
+	Frame::ThrowException("IteratorPop expression encountered outside a statement");
 }
 
 void ExpressionEvaluator::Expr(IteratorNextExpression* expr)
 {
-	Result.Result = StatementResult::IteratorNext;
+	Frame::ThrowException("IteratorNext expression encountered outside a statement");
 }
 
 void ExpressionEvaluator::Expr(StructCmpEqExpression* expr)
 {
-	ExpressionValue val1 = Eval(expr->Value1).Value;
-	ExpressionValue val2 = Eval(expr->Value2).Value;
-	Result.Value = ExpressionValue::BoolValue(val1.IsEqual(val2));
+	ExpressionValue val1 = Eval(expr->Value1);
+	ExpressionValue val2 = Eval(expr->Value2);
+	Result = ExpressionValue::BoolValue(val1.IsEqual(val2));
 }
 
 void ExpressionEvaluator::Expr(StructCmpNeExpression* expr)
 {
-	ExpressionValue val1 = Eval(expr->Value1).Value;
-	ExpressionValue val2 = Eval(expr->Value2).Value;
-	Result.Value = ExpressionValue::BoolValue(!val1.IsEqual(val2));
+	ExpressionValue val1 = Eval(expr->Value1);
+	ExpressionValue val2 = Eval(expr->Value2);
+	Result = ExpressionValue::BoolValue(!val1.IsEqual(val2));
 }
 
 void ExpressionEvaluator::Expr(StructMemberExpression* expr)
 {
 	if (expr->Field)
-		Result.Value = Eval(expr->Value).Value.Member(expr->Field);
+		Result = Eval(expr->Value).Member(expr->Field);
 	else
 		Frame::ThrowException("Null field encountered in struct member expression");
 }
@@ -376,73 +416,73 @@ void ExpressionEvaluator::Expr(UnicodeStringConstExpression* expr)
 	s.reserve(expr->Value.size());
 	for (wchar_t c : expr->Value)
 		s.push_back(c < 128 ? c : '?');
-	Result.Value = ExpressionValue::StringValue(s);
+	Result = ExpressionValue::StringValue(s);
 }
 
 void ExpressionEvaluator::Expr(RotatorToVectorExpression* expr)
 {
-	Rotator rot = Eval(expr->Value).Value.ToRotator();
-	Result.Value = ExpressionValue::VectorValue((rot.ToMatrix() * vec4(1.0f, 0.0f, 0.0f, 1.0f)).xyz());
+	Rotator rot = Eval(expr->Value).ToRotator();
+	Result = ExpressionValue::VectorValue((rot.ToMatrix() * vec4(1.0f, 0.0f, 0.0f, 1.0f)).xyz());
 }
 
 void ExpressionEvaluator::Expr(ByteToIntExpression* expr)
 {
-	Result.Value = ExpressionValue::IntValue(Eval(expr->Value).Value.ToByte());
+	Result = ExpressionValue::IntValue(Eval(expr->Value).ToByte());
 }
 
 void ExpressionEvaluator::Expr(ByteToBoolExpression* expr)
 {
-	Result.Value = ExpressionValue::BoolValue(Eval(expr->Value).Value.ToByte() != 0);
+	Result = ExpressionValue::BoolValue(Eval(expr->Value).ToByte() != 0);
 }
 
 void ExpressionEvaluator::Expr(ByteToFloatExpression* expr)
 {
-	Result.Value = ExpressionValue::FloatValue(Eval(expr->Value).Value.ToByte());
+	Result = ExpressionValue::FloatValue(Eval(expr->Value).ToByte());
 }
 
 void ExpressionEvaluator::Expr(IntToByteExpression* expr)
 {
-	Result.Value = ExpressionValue::ByteValue(Eval(expr->Value).Value.ToInt());
+	Result = ExpressionValue::ByteValue(Eval(expr->Value).ToInt());
 }
 
 void ExpressionEvaluator::Expr(IntToBoolExpression* expr)
 {
-	Result.Value = ExpressionValue::BoolValue(Eval(expr->Value).Value.ToInt());
+	Result = ExpressionValue::BoolValue(Eval(expr->Value).ToInt());
 }
 
 void ExpressionEvaluator::Expr(IntToFloatExpression* expr)
 {
-	Result.Value = ExpressionValue::FloatValue((float)Eval(expr->Value).Value.ToInt());
+	Result = ExpressionValue::FloatValue((float)Eval(expr->Value).ToInt());
 }
 
 void ExpressionEvaluator::Expr(BoolToByteExpression* expr)
 {
-	Result.Value = ExpressionValue::ByteValue(Eval(expr->Value).Value.ToBool());
+	Result = ExpressionValue::ByteValue(Eval(expr->Value).ToBool());
 }
 
 void ExpressionEvaluator::Expr(BoolToIntExpression* expr)
 {
-	Result.Value = ExpressionValue::IntValue(Eval(expr->Value).Value.ToBool());
+	Result = ExpressionValue::IntValue(Eval(expr->Value).ToBool());
 }
 
 void ExpressionEvaluator::Expr(BoolToFloatExpression* expr)
 {
-	Result.Value = ExpressionValue::FloatValue(Eval(expr->Value).Value.ToBool());
+	Result = ExpressionValue::FloatValue(Eval(expr->Value).ToBool());
 }
 
 void ExpressionEvaluator::Expr(FloatToByteExpression* expr)
 {
-	Result.Value = ExpressionValue::ByteValue((int)Eval(expr->Value).Value.ToFloat());
+	Result = ExpressionValue::ByteValue((int)Eval(expr->Value).ToFloat());
 }
 
 void ExpressionEvaluator::Expr(FloatToIntExpression* expr)
 {
-	Result.Value = ExpressionValue::IntValue((int)Eval(expr->Value).Value.ToFloat());
+	Result = ExpressionValue::IntValue((int)Eval(expr->Value).ToFloat());
 }
 
 void ExpressionEvaluator::Expr(FloatToBoolExpression* expr)
 {
-	Result.Value = ExpressionValue::BoolValue((bool)Eval(expr->Value).Value.ToFloat());
+	Result = ExpressionValue::BoolValue((bool)Eval(expr->Value).ToFloat());
 }
 
 void ExpressionEvaluator::Expr(Unknown0x46Expression* expr)
@@ -452,161 +492,166 @@ void ExpressionEvaluator::Expr(Unknown0x46Expression* expr)
 
 void ExpressionEvaluator::Expr(ObjectToBoolExpression* expr)
 {
-	Result.Value = ExpressionValue::BoolValue(Eval(expr->Value).Value.ToObject() != nullptr);
+	Result = ExpressionValue::BoolValue(Eval(expr->Value).ToObject() != nullptr);
 }
 
 void ExpressionEvaluator::Expr(NameToBoolExpression* expr)
 {
-	Result.Value = ExpressionValue::BoolValue(Eval(expr->Value).Value.ToName() != "None");
+	Result = ExpressionValue::BoolValue(Eval(expr->Value).ToName() != "None");
 }
 
 void ExpressionEvaluator::Expr(StringToByteExpression* expr)
 {
-	Result.Value = ExpressionValue::ByteValue(std::atoi(Eval(expr->Value).Value.ToString().c_str()));
+	Result = ExpressionValue::ByteValue(std::atoi(Eval(expr->Value).ToString().c_str()));
 }
 
 void ExpressionEvaluator::Expr(StringToIntExpression* expr)
 {
-	Result.Value = ExpressionValue::IntValue(std::atoi(Eval(expr->Value).Value.ToString().c_str()));
+	Result = ExpressionValue::IntValue(std::atoi(Eval(expr->Value).ToString().c_str()));
 }
 
 void ExpressionEvaluator::Expr(StringToBoolExpression* expr)
 {
-	Result.Value = ExpressionValue::BoolValue(std::atoi(Eval(expr->Value).Value.ToString().c_str()));
+	Result = ExpressionValue::BoolValue(std::atoi(Eval(expr->Value).ToString().c_str()));
 }
 
 void ExpressionEvaluator::Expr(StringToFloatExpression* expr)
 {
-	Result.Value = ExpressionValue::FloatValue((float)std::atof(Eval(expr->Value).Value.ToString().c_str()));
+	Result = ExpressionValue::FloatValue((float)std::atof(Eval(expr->Value).ToString().c_str()));
 }
 
 void ExpressionEvaluator::Expr(StringToVectorExpression* expr)
 {
-	std::string v = Eval(expr->Value).Value.ToString();
+	std::string v = Eval(expr->Value).ToString();
 	auto pos1 = v.find_first_of(',');
 	auto pos2 = v.find_first_of(',', pos1 + 1);
 	if (pos1 != std::string::npos && pos2 != std::string::npos)
 	{
-		Result.Value = ExpressionValue::VectorValue({ (float)std::atof(v.substr(0, pos1).c_str()), (float)std::atof(v.substr(pos1 + 1, pos2 - pos1 - 1).c_str()), (float)std::atof(v.substr(pos2 + 1).c_str()) });
+		Result = ExpressionValue::VectorValue({ (float)std::atof(v.substr(0, pos1).c_str()), (float)std::atof(v.substr(pos1 + 1, pos2 - pos1 - 1).c_str()), (float)std::atof(v.substr(pos2 + 1).c_str()) });
 	}
 	else
 	{
-		Result.Value = ExpressionValue::VectorValue({ 0.0f });
+		Result = ExpressionValue::VectorValue({ 0.0f });
 	}
 }
 
 void ExpressionEvaluator::Expr(StringToRotatorExpression* expr)
 {
-	std::string v = Eval(expr->Value).Value.ToString();
+	std::string v = Eval(expr->Value).ToString();
 	auto pos1 = v.find_first_of(',');
 	auto pos2 = v.find_first_of(',', pos1 + 1);
 	if (pos1 != std::string::npos && pos2 != std::string::npos)
 	{
-		Result.Value = ExpressionValue::RotatorValue({ std::atoi(v.substr(0, pos1).c_str()), std::atoi(v.substr(pos1 + 1, pos2 - pos1 - 1).c_str()), std::atoi(v.substr(pos2 + 1).c_str()) });
+		Result = ExpressionValue::RotatorValue({ std::atoi(v.substr(0, pos1).c_str()), std::atoi(v.substr(pos1 + 1, pos2 - pos1 - 1).c_str()), std::atoi(v.substr(pos2 + 1).c_str()) });
 	}
 	else
 	{
-		Result.Value = ExpressionValue::RotatorValue({ 0, 0, 0 });
+		Result = ExpressionValue::RotatorValue({ 0, 0, 0 });
 	}
 }
 
 void ExpressionEvaluator::Expr(VectorToBoolExpression* expr)
 {
-	Result.Value = ExpressionValue::BoolValue(Eval(expr->Value).Value.ToVector() != vec3(0.0f));
+	Result = ExpressionValue::BoolValue(Eval(expr->Value).ToVector() != vec3(0.0f));
 }
 
 void ExpressionEvaluator::Expr(VectorToRotatorExpression* expr)
 {
-	Result.Value = ExpressionValue::RotatorValue(Rotator::FromVector(Eval(expr->Value).Value.ToVector()));
+	Result = ExpressionValue::RotatorValue(Rotator::FromVector(Eval(expr->Value).ToVector()));
 }
 
 void ExpressionEvaluator::Expr(RotatorToBoolExpression* expr)
 {
-	Result.Value = ExpressionValue::BoolValue(Eval(expr->Value).Value.ToRotator() != Rotator(0, 0, 0));
+	Result = ExpressionValue::BoolValue(Eval(expr->Value).ToRotator() != Rotator(0, 0, 0));
 }
 
 void ExpressionEvaluator::Expr(ByteToStringExpression* expr)
 {
-	Result.Value = ExpressionValue::StringValue(std::to_string(Eval(expr->Value).Value.ToByte()));
+	Result = ExpressionValue::StringValue(std::to_string(Eval(expr->Value).ToByte()));
 }
 
 void ExpressionEvaluator::Expr(IntToStringExpression* expr)
 {
-	Result.Value = ExpressionValue::StringValue(std::to_string(Eval(expr->Value).Value.ToInt()));
+	Result = ExpressionValue::StringValue(std::to_string(Eval(expr->Value).ToInt()));
 }
 
 void ExpressionEvaluator::Expr(BoolToStringExpression* expr)
 {
-	Result.Value = ExpressionValue::StringValue(std::to_string(Eval(expr->Value).Value.ToBool()));
+	Result = ExpressionValue::StringValue(std::to_string(Eval(expr->Value).ToBool()));
 }
 
 void ExpressionEvaluator::Expr(FloatToStringExpression* expr)
 {
-	Result.Value = ExpressionValue::StringValue(std::to_string(Eval(expr->Value).Value.ToFloat()));
+	Result = ExpressionValue::StringValue(std::to_string(Eval(expr->Value).ToFloat()));
 }
 
 void ExpressionEvaluator::Expr(ObjectToStringExpression* expr)
 {
-	UObject* obj = Eval(expr->Value).Value.ToObject();
-	Result.Value = ExpressionValue::StringValue(obj ? obj->Class->Name.ToString() + "/" + obj->Name.ToString() : "None");
+	UObject* obj = Eval(expr->Value).ToObject();
+	Result = ExpressionValue::StringValue(obj ? obj->Class->Name.ToString() + "/" + obj->Name.ToString() : "None");
 }
 
 void ExpressionEvaluator::Expr(NameToStringExpression* expr)
 {
-	Result.Value = ExpressionValue::StringValue(Eval(expr->Value).Value.ToName().ToString());
+	Result = ExpressionValue::StringValue(Eval(expr->Value).ToName().ToString());
 }
 
 void ExpressionEvaluator::Expr(VectorToStringExpression* expr)
 {
-	vec3 v = Eval(expr->Value).Value.ToVector();
-	Result.Value = ExpressionValue::StringValue(std::to_string(v.x) + "," + std::to_string(v.y) + "," + std::to_string(v.z));
+	vec3 v = Eval(expr->Value).ToVector();
+	Result = ExpressionValue::StringValue(std::to_string(v.x) + "," + std::to_string(v.y) + "," + std::to_string(v.z));
 }
 
 void ExpressionEvaluator::Expr(RotatorToStringExpression* expr)
 {
-	Rotator v = Eval(expr->Value).Value.ToRotator();
-	Result.Value = ExpressionValue::StringValue(std::to_string(v.Pitch & 0xffff) + "," + std::to_string(v.Yaw & 0xffff) + "," + std::to_string(v.Roll & 0xffff));
+	Rotator v = Eval(expr->Value).ToRotator();
+	Result = ExpressionValue::StringValue(std::to_string(v.Pitch & 0xffff) + "," + std::to_string(v.Yaw & 0xffff) + "," + std::to_string(v.Roll & 0xffff));
 }
 
 void ExpressionEvaluator::Expr(VirtualFunctionExpression* expr)
 {
-	UClass* contextClass = dynamic_cast<UClass*>(Context);
+	UClass* contextClass = UObject::TryCast<UClass>(Context);
 	if (!contextClass)
 		contextClass = Context->Class;
 
-	// Search states first
+	UStruct* contextState = Context->StateFrame ? Context->StateFrame->Func : nullptr;
 
-	NameString stateName = Context->GetStateName();
-	for (UClass* cls = contextClass; cls != nullptr; cls = static_cast<UClass*>(cls->BaseStruct))
+	for (const auto& entry : expr->Cache)
 	{
-		UState* state = cls->GetState(stateName);
-		if (state)
+		if (entry.Class == contextClass && entry.State == contextState && entry.Func)
 		{
-			UFunction* func = state->GetFunction(expr->Name);
-			if (func)
-			{
-				Call(func, expr->Args);
-				return;
-			}
+			Call(entry.Func, expr->Args);
+			return;
 		}
 	}
 
-	// Search normal member functions next
+	UFunction* func = FindVirtualFunction(contextClass, contextState, expr->Name);
+	if (!func)
+		Frame::ThrowException("Script virtual function " + expr->Name.ToString() + " not found!");
 
-	for (UClass* cls = contextClass; cls != nullptr; cls = static_cast<UClass*>(cls->BaseStruct))
+	auto& entry = expr->Cache[expr->NextCacheEntry];
+	expr->NextCacheEntry = (expr->NextCacheEntry + 1) % VirtualFunctionExpression::CacheSize;
+	entry.Class = contextClass;
+	entry.State = contextState;
+	entry.Func = func;
+
+	Call(func, expr->Args);
+}
+
+UFunction* ExpressionEvaluator::FindVirtualFunction(UClass* contextClass, UStruct* contextState, const NameString& name)
+{
+	// Search states first
+
+	if (contextState)
 	{
-		for (UField* field = cls->Children; field != nullptr; field = field->Next)
-		{
-			UFunction* func = UObject::TryCast<UFunction>(field);
-			if (func && func->Name == expr->Name)
-			{
-				Call(func, expr->Args);
-				return;
-			}
-		}
+		UFunction* func = contextClass->FindStateFunction(contextState->Name, name);
+		if (func)
+			return func;
 	}
 
-	Frame::ThrowException("Script virtual function " + expr->Name.ToString() + " not found!");
+	// Search normal member functions next
+
+	return contextClass->FindFunction(name);
 }
 
 void ExpressionEvaluator::Expr(FinalFunctionExpression* expr)
@@ -618,25 +663,31 @@ void ExpressionEvaluator::Expr(GlobalFunctionExpression* expr)
 {
 	// Global function calls skip the states and only searches normal member functions
 
-	UClass* contextClass = dynamic_cast<UClass*>(Context);
+	UClass* contextClass = UObject::TryCast<UClass>(Context);
 	if (!contextClass)
 		contextClass = Context->Class;
 
-	for (UClass* cls = contextClass; cls != nullptr; cls = static_cast<UClass*>(cls->BaseStruct))
-	{
-		UFunction* func = cls->GetFunction(expr->Name);
-		if (func)
-		{
-			Call(func, expr->Args);
-			return;
-		}
-	}
+	UFunction* func = contextClass->FindFunction(expr->Name);
+	if (!func)
+		Frame::ThrowException("Script global function " + expr->Name.ToString() + " not found!");
 
-	Frame::ThrowException("Script global function " + expr->Name.ToString() + " not found!");
+	Call(func, expr->Args);
 }
 
 void ExpressionEvaluator::Expr(NativeFunctionExpression* expr)
 {
+	size_t index = expr->nativeindex;
+	if (index < NativeFunctions::IntrinsicByIndex.size() && NativeFunctions::IntrinsicByIndex[index] && expr->Args.size() <= 2)
+	{
+		ExpressionValue args[2];
+		for (size_t i = 0; i < expr->Args.size(); i++)
+			args[i] = Eval(expr->Args[i], Self, Self, LocalVariables);
+		Result = NativeFunctions::IntrinsicByIndex[index](args);
+		if (ScriptProfiler::Enabled)
+			ScriptProfiler::NativeCall(expr->nativeindex);
+		return;
+	}
+
 	Call(NativeFunctions::FuncByIndex[expr->nativeindex], expr->Args);
 }
 
@@ -644,23 +695,22 @@ void ExpressionEvaluator::Call(UFunction* func, const std::vector<Expression*>&
 {
 	if (func->NativeFuncIndex == 130)
 	{
-		Result.Value = ExpressionValue::BoolValue(Eval(exprArgs[0], Self, Self, LocalVariables).Value.ToBool() && Eval(exprArgs[1], Self, Self, LocalVariables).Value.ToBool());
+		Result = ExpressionValue::BoolValue(Eval(exprArgs[0], Self, Self, LocalVariables).ToBool() && Eval(exprArgs[1], Self, Self, LocalVariables).ToBool());
 	}
 	else if (func->NativeFuncIndex == 132)
 	{
-		Result.Value = ExpressionValue::BoolValue(Eval(exprArgs[0], Self, Self, LocalVariables).Value.ToBool() || Eval(exprArgs[1], Self, Self, LocalVariables).Value.ToBool());
+		Result = ExpressionValue::BoolValue(Eval(exprArgs[0], Self, Self, LocalVariables).ToBool() || Eval(exprArgs[1], Self, Self, LocalVariables).ToBool());
 	}
 	else
 	{
-		std::vector<ExpressionValue> args;
-		args.reserve(exprArgs.size());
+		VMArgsScope scope;
 		for (Expression* arg : exprArgs)
-			args.push_back(Eval(arg, Self, Self, LocalVariables).Value);
-		Result.Value = Frame::Call(func, Context, std::move(args));
+			scope.Args.push_back(Eval(arg, Self, Self, LocalVariables));
+		Result = Frame::Call(func, Context, scope.Args);
 	}
 }
 
 void ExpressionEvaluator::Expr(FunctionArgumentsExpression* expr)
 {
-	Result.Value = ExpressionValue::NothingValue();
+	Result = ExpressionValue::NothingValue();
 }
@@ -2,40 +2,18 @@
 
 #include "ExpressionVisitor.h"
 #include "ExpressionValue.h"
-#include "Iterator.h"
 
 class UFunction;
 
-enum class StatementResult
-{
-	Next,
-	Jump,
-	Return,
-	Stop,
-	GotoLabel,
-	Switch,
-	Iterator,
-	IteratorNext,
-	IteratorPop
-};
-
-struct ExpressionEvalResult
-{
-	StatementResult Result = StatementResult::Next;
-	uint16_t JumpAddress = 0;
-	int LatentFunction = 0;
-	NameString Label;
-	ExpressionValue Value;
-	std::unique_ptr<Iterator> Iter;
-};
-
 class ExpressionEvaluator : ExpressionVisitor
 {
 public:
-	static ExpressionEvalResult Eval(Expression* expr, UObject* self, UObject* context, void* localVariables);
+	static ExpressionValue Eval(Expression* expr, UObject* self, UObject* context, void* localVariables);
 
 private:
-	ExpressionEvalResult Eval(Expression* expr) { return Eval(expr, Self, Context, LocalVariables); }
+	static ExpressionValue EvalDebug(Expression* expr, UObject* self, UObject* context, void* localVariables);
+	ExpressionValue Eval(Expression* expr) { return Eval(expr, Self, Context, LocalVariables); }
+	void LetTracked(LetExpression* expr);
 
 	void Expr(LocalVariableExpression* expr) override;
 	void Expr(InstanceVariableExpression* expr) override;
@@ -127,8 +105,9 @@ private:
 	void Expr(FunctionArgumentsExpression* expr) override;
 
 	void Call(UFunction* func, const std::vector<Expression*>& exprArgs);
+	static UFunction* FindVirtualFunction(UClass* contextClass, UStruct* contextState, const NameString& name);
 
-	ExpressionEvalResult Result;
+	ExpressionValue Result;
 	UObject* Self = nullptr;
 	UObject* Context = nullptr;
 	void* LocalVariables = nullptr;
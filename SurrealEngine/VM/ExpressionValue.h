@@ -8,6 +8,10 @@ class UProperty;
 class StructValue
 {
 public:
+	// Structs up to this size are stored inline, which covers Plane and PointRegion (Vector and Rotator have their own value types).
+	// Larger would grow every ExpressionValue, as StructValue shares its union with std::string.
+	enum { InlineSize = 16 };
+
 	StructValue() = default;
 
 	StructValue(const StructValue& other)
@@ -29,10 +33,17 @@ public:
 	{
 		if (Struct)
 		{
-			for (UProperty* prop : Struct->Properties)
-				prop->CopyValue(
-					static_cast<uint8_t*>(dest) + prop->DataOffset,
-					static_cast<uint8_t*>(Ptr) + prop->DataOffset);
+			if (Struct->IsTriviallyCopyable())
+			{
+				memcpy(dest, Ptr, Struct->StructSize);
+			}
+			else
+			{
+				for (UProperty* prop : Struct->Properties)
+					prop->CopyValue(
+						static_cast<uint8_t*>(dest) + prop->DataOffset,
+						static_cast<uint8_t*>(Ptr) + prop->DataOffset);
+			}
 		}
 	}
 
@@ -42,11 +53,18 @@ public:
 		Struct = type;
 		if (Struct)
 		{
-			Ptr = new uint64_t[(Struct->StructSize + 7) / 8];
-			for (UProperty* prop : Struct->Properties)
-				prop->CopyConstruct(
-					static_cast<uint8_t*>(Ptr) + prop->DataOffset,
-					static_cast<uint8_t*>(src) + prop->DataOffset);
+			Ptr = Struct->StructSize <= InlineSize ? static_cast<void*>(Inline) : new uint64_t[(Struct->StructSize + 7) / 8];
+			if (Struct->IsTriviallyCopyable())
+			{
+				memcpy(Ptr, src, Struct->StructSize);
+			}
+			else
+			{
+				for (UProperty* prop : Struct->Properties)
+					prop->CopyConstruct(
+						static_cast<uint8_t*>(Ptr) + prop->DataOffset,
+						static_cast<uint8_t*>(src) + prop->DataOffset);
+			}
 		}
 	}
 
@@ -54,10 +72,15 @@ public:
 	{
 		if (Struct)
 		{
-			for (UProperty* prop : Struct->Properties)
-				prop->Destruct(static_cast<uint8_t*>(Ptr) + prop->DataOffset);
-			delete[](uint64_t*)Ptr;
+			if (!Struct->IsTriviallyCopyable())
+			{
+				for (UProperty* prop : Struct->Properties)
+					prop->Destruct(static_cast<uint8_t*>(Ptr) + prop->DataOffset);
+			}
+			if (Ptr != Inline)
+				delete[](uint64_t*)Ptr;
 			Struct = nullptr;
+			Ptr = nullptr;
 		}
 	}
 
@@ -74,16 +97,29 @@ public:
 	{
 		if (this != &other)
 		{
-			Struct = other.Struct;
-			Ptr = other.Ptr;
-			other.Struct = nullptr;
-			other.Ptr = nullptr;
+			if (other.Ptr == other.Inline)
+			{
+				// Inline data has to be copied
+				Load(other.Struct, other.Ptr);
+				other.Reset();
+			}
+			else
+			{
+				Reset();
+				Struct = other.Struct;
+				Ptr = other.Ptr;
+				other.Struct = nullptr;
+				other.Ptr = nullptr;
+			}
 		}
 		return *this;
 	}
 
 	UStruct* Struct = nullptr;
 	void* Ptr = nullptr;
+
+private:
+	uint64_t Inline[InlineSize / 8];
 };
 
 class ExpressionValue
@@ -199,7 +235,7 @@ public:
 	static ExpressionValue ObjectValue(UObject* value) { ExpressionValue v(ExpressionValueType::ValueObject); *v.PtrObject = value; return v; }
 	static ExpressionValue VectorValue(vec3 value) { ExpressionValue v(ExpressionValueType::ValueVector); *v.PtrVector = value; return v; }
 	static ExpressionValue RotatorValue(Rotator value) { ExpressionValue v(ExpressionValueType::ValueRotator); *v.PtrRotator = value; return v; }
-	static ExpressionValue StringValue(std::string value) { ExpressionValue v(ExpressionValueType::ValueString); *v.PtrString = value; return v; }
+	static ExpressionValue StringValue(std::string value) { ExpressionValue v(ExpressionValueType::ValueString); *v.PtrString = std::move(value); return v; }
 	static ExpressionValue NameValue(NameString value) { ExpressionValue v(ExpressionValueType::ValueName); *v.PtrName = value; return v; }
 	static ExpressionValue ColorValue(Color value) { ExpressionValue v(ExpressionValueType::ValueColor); *v.PtrColor = value; return v; }
 
@@ -209,6 +245,7 @@ public:
 
 	ExpressionValueType GetType() const { return Type; }
 	bool IsVariable() const { return VariableProperty; }
+	UProperty* GetVariableProperty() const { return VariableProperty; }
 
 	ExpressionValue ItemAt(int index)
 	{
@@ -314,6 +351,10 @@ private:
 	UProperty* VariableProperty = nullptr;
 };
 
+// Every script value is one of these, so keep StructValue from becoming the largest member of the union.
+// Only checked where std::string is 32 bytes (64-bit release builds), as its size decides the rest.
+static_assert(sizeof(std::string) != 32 || sizeof(ExpressionValue) == 56, "ExpressionValue grew, check StructValue::InlineSize");
+
 // Pass by value
 template<> inline uint8_t ExpressionValue::ToType() { return ToByte(); }
 template<> inline int32_t ExpressionValue::ToType() { return ToInt(); }
@@ -406,7 +447,11 @@ inline void ExpressionValue::Store(const ExpressionValue& rvalue)
 		if (rvalue.VariableProperty)
 		{
 			UStruct* Struct = static_cast<UStructProperty*>(rvalue.VariableProperty)->Struct;
-			if (Struct)
+			if (Struct && Struct->IsTriviallyCopyable())
+			{
+				memcpy(Ptr, rvalue.Ptr, Struct->StructSize);
+			}
+			else if (Struct)
 			{
 				for (UProperty* prop : Struct->Properties)
 					prop->CopyValue(
@@ -442,7 +487,7 @@ inline void ExpressionValue::Load()
 		case ExpressionValueType::ValueName: *value.PtrName = *PtrName; break;
 		case ExpressionValueType::ValueColor: *value.PtrColor = *PtrColor; break;
 		case ExpressionValueType::ValueStruct:
-			value.GetStructValue()->Load(dynamic_cast<UStructProperty*>(VariableProperty)->Struct, Ptr);
+			value.GetStructValue()->Load(static_cast<UStructProperty*>(VariableProperty)->Struct, Ptr);
 			value.Ptr = value.GetStructValue()->Ptr;
 			break;
 		}
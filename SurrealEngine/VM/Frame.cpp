@@ -4,6 +4,7 @@
 #include "Bytecode.h"
 #include "ExpressionEvaluator.h"
 #include "NativeFunc.h"
+#include "ScriptProfiler.h"
 #include "UObject/UTextBuffer.h"
 #include "UI/Debugger/DebuggerWindow.h"
 #include "Audio/AudioSubsystem.h"
@@ -16,6 +17,7 @@ std::vector<Frame*> Frame::Callstack;
 FrameRunState Frame::RunState = FrameRunState::Running;
 Frame* Frame::StepFrame = nullptr;
 Expression* Frame::StepExpression = nullptr;
+bool Frame::DebuggerActive = false;
 std::string Frame::ExceptionText;
 std::unique_ptr<Iterator> Frame::CreatedIterator;
 
@@ -30,7 +32,8 @@ void Frame::AddBreakpoint(const NameString& packageName, const NameString& clsNa
 			if (child->Name == funcName && dynamic_cast<UFunction*>(child))
 			{
 				UFunction* func = static_cast<UFunction*>(child);
-				Breakpoints.push_back(func->Code->Statements.front());
+				Breakpoints.push_back(func->GetCode()->Statements.front());
+				Breakpoints.back()->Breakpoint = true;
 				return;
 			}
 		}
@@ -47,7 +50,8 @@ void Frame::AddBreakpoint(const NameString& packageName, const NameString& clsNa
 					if (child->Name == funcName && dynamic_cast<UFunction*>(child))
 					{
 						UFunction* func = static_cast<UFunction*>(child);
-						Breakpoints.push_back(func->Code->Statements.front());
+						Breakpoints.push_back(func->GetCode()->Statements.front());
+						Breakpoints.back()->Breakpoint = true;
 						return;
 					}
 				}
@@ -64,7 +68,9 @@ void Frame::ShowDebuggerWindow()
 		Debugger = new DebuggerWindow([]() {
 			delete Debugger;
 			Debugger = nullptr;
+			DebuggerActive = false;
 		});
+		DebuggerActive = true;
 		Debugger->show();
 	}
 
@@ -158,41 +164,23 @@ std::string Frame::GetCallstack()
 	return result;
 }
 
-ExpressionValue Frame::Call(UFunction* func, UObject* instance, std::vector<ExpressionValue> args)
+ExpressionValue Frame::Call(UFunction* func, UObject* instance, std::vector<ExpressionValue>& args)
 {
-	int argindex = 0;
-	for (UField* field = func->Children; field != nullptr; field = field->Next)
-	{
-		UProperty* prop = dynamic_cast<UProperty*>(field);
-		if (prop)
-		{
-			if (argindex == args.size() && AllFlags(prop->PropFlags, PropertyFlags::Parm | PropertyFlags::OptionalParm))
-				args.push_back(ExpressionValue::NothingValue());
+	ScriptProfilerScope profilerScope(func);
 
-			if (AllFlags(prop->PropFlags, PropertyFlags::Parm))
-				argindex++;
-		}
-	}
+	const FunctionLayout& layout = func->Layout;
+
+	for (size_t i = args.size(); i < layout.Parms.size() && AllFlags(layout.Parms[i]->PropFlags, PropertyFlags::OptionalParm); i++)
+		args.push_back(ExpressionValue::NothingValue());
 
 	if (AllFlags(func->FuncFlags, FunctionFlags::Native))
 	{
-		bool returnparmfound = false;
-		argindex = 0;
-		for (UField* field = func->Children; field != nullptr; field = field->Next)
-		{
-			UProperty* prop = dynamic_cast<UProperty*>(field);
-			if (prop)
-			{
-				if (AllFlags(prop->PropFlags, PropertyFlags::Parm | PropertyFlags::ReturnParm))
-				{
-					ExpressionValue retval = ExpressionValue::PropertyValue(prop);
-					args.push_back(std::move(retval));
-					returnparmfound = true;
-				}
-				if (AllFlags(prop->PropFlags, PropertyFlags::Parm))
-					argindex++;
-			}
-		}
+		if (ScriptProfiler::Enabled && func->NativeFuncIndex != 0)
+			ScriptProfiler::NativeCall(func->NativeFuncIndex);
+
+		bool returnparmfound = layout.ReturnIsParm;
+		if (returnparmfound)
+			args.push_back(ExpressionValue::PropertyValue(layout.ReturnParm));
 
 		try
 		{
@@ -222,54 +210,35 @@ ExpressionValue Frame::Call(UFunction* func, UObject* instance, std::vector<Expr
 	}
 	else
 	{
-		Frame frame(instance, func);
+		Frame frame(instance, func, VMStack::Get());
 
-		int argindex = 0;
-		for (UField* field = func->Children; field != nullptr; field = field->Next)
+		// Trivial locals are zero initialized when the frame is allocated
+		if (!layout.TrivialLocals)
 		{
-			UProperty* prop = dynamic_cast<UProperty*>(field);
-			if (prop)
-			{
-				ExpressionValue lvalue = ExpressionValue::Variable(frame.Variables.get(), prop);
-				lvalue.ConstructVariable();
-				if (AllFlags(prop->PropFlags, PropertyFlags::Parm))
-				{
-					if (argindex < args.size())
-					{
-						lvalue.Store(args[argindex]);
-					}
-
-					argindex++;
-				}
-			}
+			for (UProperty* prop : layout.NonTrivialLocals)
+				ExpressionValue::Variable(frame.Variables, prop).ConstructVariable();
 		}
 
-		ExpressionValue result = frame.Run().Value;
+		size_t argcount = std::min(args.size(), layout.Parms.size());
+		for (size_t i = 0; i < argcount; i++)
+			ExpressionValue::Variable(frame.Variables, layout.Parms[i]).Store(args[i]);
+
+		ExpressionValue result = frame.Run();
 		result.Load();
 
-		argindex = 0;
-		for (UField* field = func->Children; field != nullptr; field = field->Next)
+		for (auto& outparm : layout.OutParms)
 		{
-			UProperty* prop = dynamic_cast<UProperty*>(field);
-			if (prop)
-			{
-				ExpressionValue lvalue = ExpressionValue::Variable(frame.Variables.get(), prop);
-
-				if (AllFlags(prop->PropFlags, PropertyFlags::Parm | PropertyFlags::OutParm) && argindex < args.size())
-				{
-					args[argindex].Store(lvalue);
-				}
-
-				if (AllFlags(prop->PropFlags, PropertyFlags::ReturnParm) && result.GetType() == ExpressionValueType::Nothing)
-				{
-					result = ExpressionValue::DefaultValue(prop);
-				}
+			if (outparm.second < (int)args.size())
+				args[outparm.second].Store(ExpressionValue::Variable(frame.Variables, outparm.first));
+		}
 
-				if (AllFlags(prop->PropFlags, PropertyFlags::Parm))
-					argindex++;
+		if (layout.ReturnParm && result.GetType() == ExpressionValueType::Nothing)
+			result = ExpressionValue::DefaultValue(layout.ReturnParm);
 
-				lvalue.DestructVariable();
-			}
+		if (!layout.TrivialLocals)
+		{
+			for (UProperty* prop : layout.NonTrivialLocals)
+				ExpressionValue::Variable(frame.Variables, prop).DestructVariable();
 		}
 
 		return result;
@@ -282,13 +251,33 @@ Frame::Frame(UObject* instance, UStruct* func)
 	SetState(func);
 }
 
+Frame::Frame(UObject* instance, UFunction* func, VMStack& stack) : Object(instance), Func(func), Stack(&stack), StackMark(stack.GetMark())
+{
+	size_t size = (func->StructSize + 7) / 8 * sizeof(uint64_t);
+	Variables = static_cast<uint64_t*>(stack.Alloc(size));
+	memset(Variables, 0, size);
+}
+
+Frame::~Frame()
+{
+	if (Stack)
+		Stack->Release(StackMark);
+}
+
 void Frame::SetState(UStruct* func)
 {
 	Func = func;
 	if (func)
-		Variables.reset(new uint64_t[(func->StructSize + 7) / 8]);
+	{
+		size_t count = (func->StructSize + 7) / 8;
+		HeapVariables.reset(new uint64_t[count]);
+		memset(HeapVariables.get(), 0, count * sizeof(uint64_t));
+	}
 	else
-		Variables.reset();
+	{
+		HeapVariables.reset();
+	}
+	Variables = HeapVariables.get();
 }
 
 void Frame::GotoLabel(const NameString& label)
@@ -298,7 +287,7 @@ void Frame::GotoLabel(const NameString& label)
 		UState* state = cls->GetState(Func->Name);
 		if (state)
 		{
-			int labelIndex = state->Code->FindLabelIndex(label.IsNone() ? NameString("Begin") : label);
+			int labelIndex = state->GetCode()->FindLabelIndex(label.IsNone() ? NameString("Begin") : label);
 			if (labelIndex != -1)
 			{
 				Func = state;
@@ -313,19 +302,23 @@ void Frame::GotoLabel(const NameString& label)
 
 void Frame::Tick()
 {
-	if (LatentState == LatentRunState::Continue)
+	// Func is null after GotoState('None')
+	if (LatentState == LatentRunState::Continue && Func)
+	{
+		ScriptProfilerScope profilerScope(Func);
 		Run();
+	}
 }
 
-ExpressionEvalResult Frame::Run()
+ExpressionValue Frame::Run()
 {
 	if (!Func)
 		return {};
 
 	Callstack.push_back(this);
 
-	if (!Func->Code->Statements.empty())
-		StepExpression = Func->Code->Statements[StatementIndex];
+	if (!Func->GetCode()->Statements.empty())
+		StepExpression = Func->GetCode()->Statements[StatementIndex];
 
 	if (RunState == FrameRunState::StepInto)
 	{
@@ -336,70 +329,103 @@ ExpressionEvalResult Frame::Run()
 	int instructionsRetired = 0;
 	while (instructionsRetired < maxInstructions)
 	{
-		if (StatementIndex >= Func->Code->Statements.size())
+		Bytecode* code = Func->GetCode();
+		if (code->Compiled && !DebuggerActive && Breakpoints.empty())
+		{
+			ExpressionValue result;
+			if (code->Compiled(this, result))
+			{
+				Callstack.pop_back();
+				return result;
+			}
+
+			// The compiled code returns false when GotoState moved the frame elsewhere
+			if (!Func || (Object->StateFrame.get() == this && LatentState != LatentRunState::Continue))
+			{
+				Callstack.pop_back();
+				return {};
+			}
+			instructionsRetired++;
+			continue;
+		}
+
+		if (StatementIndex >= code->Instructions.size())
 			ThrowException("Unexpected end of code statements");
 
 		// Note: GotoState may change StatementIndex (jump to a different location) so we have to increment the index before executing the statement
 		size_t curStatementIndex = StatementIndex;
 		StatementIndex++;
 
-		StepExpression = Func->Code->Statements[curStatementIndex];
+		StepExpression = code->Statements[curStatementIndex];
+
+		const Instruction& inst = code->Instructions[curStatementIndex];
 
 		if (RunState == FrameRunState::StepOver && StepFrame == this)
 		{
 			Break();
 		}
-
-		Expression* statement = Func->Code->Statements[curStatementIndex];
-		ExpressionEvalResult result = ExpressionEvaluator::Eval(statement, Object, Object, Variables.get());
-		if (!Func)
-			return result;
-		switch (result.Result)
+		else if (StepExpression->Breakpoint && inst.Op != Opcode::Eval) // Eval statements break in ExpressionEvaluator::Eval
+		{
+			Break();
+		}
+		switch (inst.Op)
 		{
-		case StatementResult::Next:
+		case Opcode::Eval:
+			ExpressionEvaluator::Eval(inst.Operand, Object, Object, Variables);
+			break;
+		case Opcode::Nothing:
+		case Opcode::Case:
+			break;
+		case Opcode::Jump:
+			StatementIndex = inst.Target;
 			break;
-		case StatementResult::Jump:
-			StatementIndex = Func->Code->FindStatementIndex(result.JumpAddress);
+		case Opcode::JumpIfNot:
+			if (!ExpressionEvaluator::Eval(inst.Operand, Object, Object, Variables).ToBool())
+				StatementIndex = inst.Target;
 			break;
-		case StatementResult::Switch:
-			ProcessSwitch(result.Value);
+		case Opcode::Switch:
+			ProcessSwitch(ExpressionEvaluator::Eval(inst.Operand, Object, Object, Variables));
 			break;
-		case StatementResult::GotoLabel:
-			StatementIndex = Func->Code->FindLabelIndex(result.Label);
+		case Opcode::GotoLabel:
+			StatementIndex = code->FindLabelIndex(ExpressionEvaluator::Eval(inst.Operand, Object, Object, Variables).ToName());
 			break;
-		case StatementResult::Stop:
+		case Opcode::Stop:
 			LatentState = LatentRunState::Stop;
 			Callstack.pop_back();
-			return result;
-		case StatementResult::Return:
-			// Package 61 and earlier transfered the return value in an out parameter
-			if (!static_cast<ReturnExpression*>(statement)->Value)
+			return {};
+		case Opcode::Return:
+		{
+			ExpressionValue result;
+			if (inst.Operand)
+			{
+				result = ExpressionEvaluator::Eval(inst.Operand, Object, Object, Variables);
+			}
+			else if (Func)
 			{
-				for (UField* field = Func->Children; field != nullptr; field = field->Next)
+				// Package 61 and earlier transfered the return value in an out parameter
+				UFunction* func = UObject::TryCast<UFunction>(Func);
+				if (func && func->Layout.ReturnIsParm)
 				{
-					UProperty* prop = dynamic_cast<UProperty*>(field);
-					if (prop && AllFlags(prop->PropFlags, PropertyFlags::Parm | PropertyFlags::ReturnParm))
-					{
-						result.Value = ExpressionValue::PropertyValue(prop);
-						result.Value.Load();
-						break;
-					}
+					result = ExpressionValue::PropertyValue(func->Layout.ReturnParm);
+					result.Load();
 				}
 			}
 			Callstack.pop_back();
 			return result;
-		case StatementResult::Iterator:
-			if (!result.Iter)
+		}
+		case Opcode::Iterator:
+			ExpressionEvaluator::Eval(inst.Operand, Object, Object, Variables);
+			if (!CreatedIterator)
 				ThrowException("Iterator statement without an iterator!");
-			Iterators.push_back(std::move(result.Iter));
+			Iterators.push_back(std::move(CreatedIterator));
 			Iterators.back()->StartStatementIndex = curStatementIndex + 1;
-			Iterators.back()->EndStatementIndex = Func->Code->FindStatementIndex(result.JumpAddress);
+			Iterators.back()->EndStatementIndex = inst.Target;
 			if (Iterators.back()->Next())
 				StatementIndex = Iterators.back()->StartStatementIndex;
 			else
 				StatementIndex = Iterators.back()->EndStatementIndex;
 			break;
-		case StatementResult::IteratorNext:
+		case Opcode::IteratorNext:
 			if (Iterators.empty())
 				ThrowException("Iterator next statement without an iterator!");
 			if (Iterators.back()->Next())
@@ -407,17 +433,17 @@ ExpressionEvalResult Frame::Run()
 			else
 				StatementIndex = Iterators.back()->EndStatementIndex;
 			break;
-		case StatementResult::IteratorPop:
+		case Opcode::IteratorPop:
 			if (Iterators.empty())
 				ThrowException("Iterator pop statement without an iterator!");
 			Iterators.pop_back();
 			break;
 		}
 
-		if (Object->StateFrame.get() == this && LatentState != LatentRunState::Continue)
+		if (!Func || (Object->StateFrame.get() == this && LatentState != LatentRunState::Continue))
 		{
 			Callstack.pop_back();
-			return result;
+			return {};
 		}
 
 		instructionsRetired++;
@@ -429,17 +455,17 @@ ExpressionEvalResult Frame::Run()
 
 void Frame::ProcessSwitch(const ExpressionValue& condition)
 {
-	SwitchExpression* switchexpr = static_cast<SwitchExpression*>(Func->Code->Statements[StatementIndex - 1]);
+	const std::vector<Instruction>& instructions = Func->GetCode()->Instructions;
 	while (true)
 	{
-		CaseExpression* caseexpr = static_cast<CaseExpression*>(Func->Code->Statements[StatementIndex++]);
-		if (caseexpr->Value)
+		const Instruction& caseinst = instructions[StatementIndex++];
+		if (caseinst.Operand)
 		{
-			ExpressionValue casevalue = ExpressionEvaluator::Eval(caseexpr->Value, Object, Object, Variables.get()).Value;
+			ExpressionValue casevalue = ExpressionEvaluator::Eval(caseinst.Operand, Object, Object, Variables);
 			if (condition.IsEqual(casevalue))
 				break;
 			else
-				StatementIndex = Func->Code->FindStatementIndex(caseexpr->NextOffset);
+				StatementIndex = caseinst.Target;
 		}
 		else
 		{
@@ -2,13 +2,13 @@
 
 #include "ExpressionValue.h"
 #include "Iterator.h"
+#include "VMStack.h"
 
 class DebuggerWindow;
 class Bytecode;
 class UObject;
 class UFunction;
 class Expression;
-struct ExpressionEvalResult;
 
 enum class FrameRunState
 {
@@ -19,6 +19,7 @@ enum class FrameRunState
 	StepOut
 };
 
+// What state code is suspended on. Continue means it is runnable.
 enum class LatentRunState
 {
 	Continue,
@@ -38,7 +39,7 @@ enum class LatentRunState
 class Frame
 {
 public:
-	static ExpressionValue Call(UFunction* func, UObject* instance, std::vector<ExpressionValue> args);
+	static ExpressionValue Call(UFunction* func, UObject* instance, std::vector<ExpressionValue>& args);
 	static std::string GetCallstack();
 
 	static void AddBreakpoint(const NameString& package, const NameString& cls, const NameString& func, const NameString& state = {});
@@ -49,6 +50,7 @@ public:
 	static FrameRunState RunState;
 	static Frame* StepFrame;
 	static Expression* StepExpression;
+	static bool DebuggerActive; // Track the current expression for the debugger
 	static std::string ExceptionText;
 
 	static void ShowDebuggerWindow();
@@ -61,6 +63,7 @@ public:
 	static std::unique_ptr<Iterator> CreatedIterator;
 
 	Frame(UObject* instance, UStruct* func);
+	~Frame();
 
 	void SetState(UStruct* func);
 
@@ -69,13 +72,25 @@ public:
 
 	LatentRunState LatentState = LatentRunState::Continue;
 
-	std::unique_ptr<uint64_t[]> Variables;
+	uint64_t* Variables = nullptr;
 	UObject* Object = nullptr;
 	UStruct* Func = nullptr;
 	size_t StatementIndex = 0;
 	std::vector<std::unique_ptr<Iterator>> Iterators;
 
 private:
-	ExpressionEvalResult Run();
+	Frame(UObject* instance, UFunction* func, VMStack& stack);
+	Frame(const Frame&) = delete;
+	Frame& operator=(const Frame&) = delete;
+
+	// State frames outlive the call that created them and keep their locals on the heap
+	std::unique_ptr<uint64_t[]> HeapVariables;
+	VMStack* Stack = nullptr;
+	VMStack::Mark StackMark;
+
+	ExpressionValue Run();
+
+public:
+	// Used by CompiledScript code
 	void ProcessSwitch(const ExpressionValue& condition);
 };
@@ -5,18 +5,40 @@
 #include "UObject/ULevel.h"
 #include "UObject/UActor.h"
 
-AllObjectsIterator::AllObjectsIterator(UObject* BaseClass, UObject** ReturnValue, NameString MatchTag) : BaseClass(BaseClass), ReturnValue(ReturnValue), MatchTag(MatchTag)
+AllObjectsIterator::AllObjectsIterator(UObject* BaseClass, UObject** ReturnValue, NameString MatchTag) : BaseClass(UObject::Cast<UClass>(BaseClass)), ReturnValue(ReturnValue), MatchTag(MatchTag)
 {
+	if (!this->BaseClass)
+		return;
+
+	if (!MatchTag.IsNone())
+	{
+		Actors = &engine->Level->GetActorsWithTag(MatchTag);
+		TagLevel = engine->Level;
+		TagLevel->TagIterators++;
+	}
+	else
+	{
+		Actors = &engine->Level->GetActorsOfClass(this->BaseClass);
+	}
+}
+
+AllObjectsIterator::~AllObjectsIterator()
+{
+	if (TagLevel && TagLevel == engine->Level)
+		TagLevel->TagIterators--;
 }
 
 bool AllObjectsIterator::Next()
 {
+	if (!Actors)
+		return false;
+
+	// Note: the list may grow while iterating if the loop body spawns actors
 	bool matchTag = !MatchTag.IsNone();
-	size_t size = engine->Level->Actors.size();
-	while (index < size)
+	while (index < Actors->size())
 	{
-		UActor* actor = engine->Level->Actors[index++];
-		if (actor && actor->IsA(BaseClass->Name) && (!matchTag || actor->Tag() == MatchTag))
+		UActor* actor = (*Actors)[index++];
+		if (actor && (!matchTag || (actor->Tag() == MatchTag && actor->IsA(BaseClass))))
 		{
 			*ReturnValue = actor;
 			return true;
@@ -27,79 +49,191 @@ bool AllObjectsIterator::Next()
 
 /////////////////////////////////////////////////////////////////////////////
 
-BasedActorsIterator::BasedActorsIterator(UObject* BaseClass, UObject** Actor) : BaseClass(BaseClass), Actor(Actor)
+BasedActorsIterator::BasedActorsIterator(UActor* Self, UObject* BaseClass, UObject** Actor) : BaseClass(UObject::Cast<UClass>(BaseClass)), Actor(Actor), Actors(Self->BasedChildren)
 {
-	engine->LogUnimplemented("Actor.BasedActors");
 }
 
 bool BasedActorsIterator::Next()
 {
+	if (!BaseClass)
+		return false;
+
+	size_t size = Actors.size();
+	while (index < size)
+	{
+		UActor* actor = Actors[index++];
+		if (!actor->bDeleteMe() && actor->IsA(BaseClass))
+		{
+			*Actor = actor;
+			return true;
+		}
+	}
 	return false;
 }
 
 /////////////////////////////////////////////////////////////////////////////
 
-ChildActorsIterator::ChildActorsIterator(UObject* BaseClass, UObject** Actor) : BaseClass(BaseClass), Actor(Actor)
+ChildActorsIterator::ChildActorsIterator(UActor* Self, UObject* BaseClass, UObject** Actor) : BaseClass(UObject::Cast<UClass>(BaseClass)), Actor(Actor), Actors(Self->OwnedChildren)
 {
-	engine->LogUnimplemented("Actor.ChildActors");
 }
 
 bool ChildActorsIterator::Next()
 {
+	if (!BaseClass)
+		return false;
+
+	size_t size = Actors.size();
+	while (index < size)
+	{
+		UActor* actor = Actors[index++];
+		if (!actor->bDeleteMe() && actor->IsA(BaseClass))
+		{
+			*Actor = actor;
+			return true;
+		}
+	}
 	return false;
 }
 
 /////////////////////////////////////////////////////////////////////////////
 
-RadiusActorsIterator::RadiusActorsIterator(UObject* BaseClass, UObject** Actor, float Radius, vec3 Location) : BaseClass(BaseClass), Actor(Actor), Radius(Radius), Location(Location)
+RadiusActorsIterator::RadiusActorsIterator(UObject* BaseClass, UObject** Actor, float Radius, vec3 Location) : BaseClass(UObject::Cast<UClass>(BaseClass)), Actor(Actor), Radius(Radius), Location(Location)
 {
-	engine->LogUnimplemented("Actor.RadiusActors");
+	if (!this->BaseClass)
+		return;
+
+	// Very large radii are cheaper to handle by walking the class list
+	if (engine->Level->Hash.NearbyActors(Location, Radius, NearbyActors))
+		Actors = &NearbyActors;
+	else
+		Actors = &engine->Level->GetActorsOfClass(this->BaseClass);
 }
 
 bool RadiusActorsIterator::Next()
 {
+	if (!Actors)
+		return false;
+
+	while (index < Actors->size())
+	{
+		UActor* actor = (*Actors)[index++];
+		if (actor && !actor->bDeleteMe() && actor->IsA(BaseClass))
+		{
+			vec3 delta = actor->Location() - Location;
+			float maxDist = Radius + actor->CollisionRadius();
+			if (dot(delta, delta) < maxDist * maxDist)
+			{
+				*Actor = actor;
+				return true;
+			}
+		}
+	}
 	return false;
 }
 
 /////////////////////////////////////////////////////////////////////////////
 
-TouchingActorsIterator::TouchingActorsIterator(UObject* BaseClass, UObject** Actor) : BaseClass(BaseClass), Actor(Actor)
+TouchingActorsIterator::TouchingActorsIterator(UActor* Self, UObject* BaseClass, UObject** Actor) : BaseClass(UObject::Cast<UClass>(BaseClass)), Actor(Actor)
 {
-	engine->LogUnimplemented("Actor.TouchingActors");
+	UActor** touching = Self->Touching();
+	for (int i = 0; i < UActor::TouchingArraySize; i++)
+	{
+		if (touching[i])
+			Actors.push_back(touching[i]);
+	}
 }
 
 bool TouchingActorsIterator::Next()
 {
+	if (!BaseClass)
+		return false;
+
+	size_t size = Actors.size();
+	while (index < size)
+	{
+		UActor* actor = Actors[index++];
+		if (actor->IsA(BaseClass))
+		{
+			*Actor = actor;
+			return true;
+		}
+	}
 	return false;
 }
 
 /////////////////////////////////////////////////////////////////////////////
 
-TraceActorsIterator::TraceActorsIterator(UObject* BaseClass, UObject** Actor, vec3* HitLoc, vec3* HitNorm, const vec3& End, const vec3& Start, const vec3& Extent) : BaseClass(BaseClass), Actor(Actor), HitLoc(HitLoc), HitNorm(HitNorm), End(End), Start(Start), Extent(Extent)
+TraceActorsIterator::TraceActorsIterator(UObject* BaseClass, UObject** Actor, vec3* HitLoc, vec3* HitNorm, const vec3& End, const vec3& Start, const vec3& Extent) : BaseClass(UObject::Cast<UClass>(BaseClass)), Actor(Actor), HitLoc(HitLoc), HitNorm(HitNorm), End(End), Start(Start), Extent(Extent)
 {
-	engine->LogUnimplemented("Actor.TraceActors");
+	for (const SweepHit& hit : engine->Level->Trace(Start, End, Extent.z, Extent.x, true, false, false))
+	{
+		if (hit.Actor)
+			Hits.push_back(hit);
+	}
 }
 
 bool TraceActorsIterator::Next()
 {
+	if (!BaseClass)
+		return false;
+
+	size_t size = Hits.size();
+	while (index < size)
+	{
+		const SweepHit& hit = Hits[index++];
+		if (!hit.Actor->bDeleteMe() && hit.Actor->IsA(BaseClass))
+		{
+			*Actor = hit.Actor;
+			*HitLoc = Start + (End - Start) * hit.Fraction;
+			*HitNorm = hit.Normal;
+			return true;
+		}
+	}
 	return false;
 }
 
 /////////////////////////////////////////////////////////////////////////////
 
-VisibleActorsIterator::VisibleActorsIterator(UObject* BaseClass, UObject** Actor, float Radius, const vec3& Location) : BaseClass(BaseClass), Actor(Actor), Radius(Radius), Location(Location)
+VisibleActorsIterator::VisibleActorsIterator(UObject* BaseClass, UObject** Actor, float Radius, const vec3& Location) : BaseClass(UObject::Cast<UClass>(BaseClass)), Actor(Actor), Radius(Radius), Location(Location)
 {
-	engine->LogUnimplemented("Actor.VisibleActor");
+	if (!this->BaseClass)
+		return;
+
+	// A radius of zero means no distance limit
+	if (Radius != 0.0f && engine->Level->Hash.NearbyActors(Location, Radius, NearbyActors))
+		Actors = &NearbyActors;
+	else
+		Actors = &engine->Level->GetActorsOfClass(this->BaseClass);
 }
 
 bool VisibleActorsIterator::Next()
 {
+	if (!Actors)
+		return false;
+
+	while (index < Actors->size())
+	{
+		UActor* actor = (*Actors)[index++];
+		if (actor && !actor->bDeleteMe() && !actor->bHidden() && actor->IsA(BaseClass))
+		{
+			vec3 delta = actor->Location() - Location;
+			if (Radius == 0.0f || dot(delta, delta) < Radius * Radius)
+			{
+				// Distance is checked first as the BSP trace is by far the most expensive part
+				if (!engine->Level->TraceRayAnyHit(Location, actor->Location(), nullptr, false, true, true))
+				{
+					*Actor = actor;
+					return true;
+				}
+			}
+		}
+	}
 	return false;
 }
 
 /////////////////////////////////////////////////////////////////////////////
 
-VisibleCollidingActorsIterator::VisibleCollidingActorsIterator(UObject* BaseClass, UObject** ReturnValue, float Radius, const vec3& Location, bool IgnoreHidden) : BaseClass(BaseClass), ReturnValue(ReturnValue), Radius(Radius), Location(Location), IgnoreHidden(IgnoreHidden)
+VisibleCollidingActorsIterator::VisibleCollidingActorsIterator(UObject* BaseClass, UObject** ReturnValue, float Radius, const vec3& Location, bool IgnoreHidden) : BaseClass(UObject::Cast<UClass>(BaseClass)), ReturnValue(ReturnValue), Radius(Radius), Location(Location), IgnoreHidden(IgnoreHidden)
 {
 	HitActors = engine->Level->Hash.CollidingActors(Location, Radius);
 }
@@ -110,7 +244,7 @@ bool VisibleCollidingActorsIterator::Next()
 	while (index < size)
 	{
 		UActor* actor = HitActors[index++];
-		if (actor && (IgnoreHidden || !actor->bHidden()) && actor->IsA(BaseClass->Name))
+		if (actor && (IgnoreHidden || !actor->bHidden()) && actor->IsA(BaseClass))
 		{
 			*ReturnValue = actor;
 			return true;
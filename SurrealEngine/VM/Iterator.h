@@ -1,9 +1,11 @@
 #pragma once
 
 #include "ExpressionValue.h"
+#include "Collision/TraceHit.h"
 
 class UZoneInfo;
 class UActor;
+class ULevel;
 
 class Iterator
 {
@@ -19,34 +21,39 @@ class AllObjectsIterator : public Iterator
 {
 public:
 	AllObjectsIterator(UObject* BaseClass, UObject** ReturnValue, NameString MatchTag);
+	~AllObjectsIterator();
 	bool Next() override;
 
 private:
-	UObject* BaseClass = nullptr;
+	ULevel* TagLevel = nullptr;
+	UClass* BaseClass = nullptr;
 	UObject** ReturnValue = nullptr;
 	NameString MatchTag;
+	const std::vector<UActor*>* Actors = nullptr;
 	size_t index = 0;
 };
 
 class BasedActorsIterator : public Iterator
 {
 public:
-	BasedActorsIterator(UObject* BaseClass, UObject** Actor);
+	BasedActorsIterator(UActor* Self, UObject* BaseClass, UObject** Actor);
 	bool Next() override;
 
-	UObject* BaseClass = nullptr;
+	UClass* BaseClass = nullptr;
 	UObject** Actor = nullptr;
+	std::vector<UActor*> Actors;
 	size_t index = 0;
 };
 
 class ChildActorsIterator : public Iterator
 {
 public:
-	ChildActorsIterator(UObject* BaseClass, UObject** Actor);
+	ChildActorsIterator(UActor* Self, UObject* BaseClass, UObject** Actor);
 	bool Next() override;
 
-	UObject* BaseClass = nullptr;
+	UClass* BaseClass = nullptr;
 	UObject** Actor = nullptr;
+	std::vector<UActor*> Actors;
 	size_t index = 0;
 };
 
@@ -56,21 +63,24 @@ public:
 	RadiusActorsIterator(UObject* BaseClass, UObject** Actor, float Radius, vec3 Location);
 	bool Next() override;
 
-	UObject* BaseClass = nullptr;
+	UClass* BaseClass = nullptr;
 	UObject** Actor = nullptr;
 	float Radius = 0.0f;
 	vec3 Location;
+	std::vector<UActor*> NearbyActors;
+	const std::vector<UActor*>* Actors = nullptr;
 	size_t index = 0;
 };
 
 class TouchingActorsIterator : public Iterator
 {
 public:
-	TouchingActorsIterator(UObject* BaseClass, UObject** Actor);
+	TouchingActorsIterator(UActor* Self, UObject* BaseClass, UObject** Actor);
 	bool Next() override;
 
-	UObject* BaseClass = nullptr;
+	UClass* BaseClass = nullptr;
 	UObject** Actor = nullptr;
+	std::vector<UActor*> Actors;
 	size_t index = 0;
 };
 
@@ -80,13 +90,14 @@ public:
 	TraceActorsIterator(UObject* BaseClass, UObject** Actor, vec3* HitLoc, vec3* HitNorm, const vec3& End, const vec3& Start, const vec3& Extent);
 	bool Next() override;
 
-	UObject* BaseClass = nullptr;
+	UClass* BaseClass = nullptr;
 	UObject** Actor = nullptr;
 	vec3* HitLoc = nullptr;
 	vec3* HitNorm = nullptr;
 	vec3 End = vec3(0.0f);
 	vec3 Start = vec3(0.0f);
 	vec3 Extent = vec3(0.0f);
+	std::vector<SweepHit> Hits;
 	size_t index = 0;
 };
 
@@ -96,10 +107,12 @@ public:
 	VisibleActorsIterator(UObject* BaseClass, UObject** Actor, float Radius, const vec3& Location);
 	bool Next() override;
 
-	UObject* BaseClass = nullptr;
+	UClass* BaseClass = nullptr;
 	UObject** Actor = nullptr;
 	float Radius = 0.0f;
 	vec3 Location = vec3(0.0f);
+	std::vector<UActor*> NearbyActors;
+	const std::vector<UActor*>* Actors = nullptr;
 	size_t index = 0;
 };
 
@@ -109,7 +122,7 @@ public:
 	VisibleCollidingActorsIterator(UObject* BaseClass, UObject** ReturnValue, float Radius, const vec3& Location, bool IgnoreHidden);
 	bool Next() override;
 
-	UObject* BaseClass = nullptr;
+	UClass* BaseClass = nullptr;
 	UObject** ReturnValue = nullptr;
 	float Radius = 0.0f;
 	vec3 Location = vec3(0.0f);
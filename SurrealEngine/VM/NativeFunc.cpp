@@ -5,6 +5,7 @@
 std::vector<UFunction*> NativeFunctions::FuncByIndex;
 std::vector<NativeFuncHandler> NativeFunctions::NativeByIndex;
 std::map<std::pair<NameString, NameString>, NativeFuncHandler> NativeFunctions::NativeByName;
+std::vector<NativeIntrinsic> NativeFunctions::IntrinsicByIndex;
 
 void NativeFunctions::RegisterHandler(const NameString& className, const NameString& funcName, int nativeIndex, NativeFuncHandler handler)
 {
@@ -28,3 +29,9 @@ void NativeFunctions::RegisterNativeFunc(UFunction* func)
 		FuncByIndex[nativeIndex] = func;
 	}
 }
+
+void NativeFunctions::RegisterIntrinsic(int nativeIndex, NativeIntrinsic intrinsic)
+{
+	if (IntrinsicByIndex.size() <= (size_t)nativeIndex) IntrinsicByIndex.resize((size_t)nativeIndex + 1);
+	IntrinsicByIndex[nativeIndex] = intrinsic;
+}
@@ -1,13 +1,27 @@
 #pragma once
 
 #include "ExpressionValue.h"
-#include <functional>
+#include <utility>
 
 class UObject;
 class UFunction;
 class ExpressionValue;
 
-typedef std::function<void(UObject* self, ExpressionValue* Args)> NativeFuncHandler;
+typedef void(*NativeFuncPtr)();
+typedef void(*NativeFuncThunk)(NativeFuncPtr func, UObject* self, ExpressionValue* Args);
+
+// A native function pointer (type erased) together with the thunk that knows its real signature
+struct NativeFuncHandler
+{
+	NativeFuncThunk Thunk = nullptr;
+	NativeFuncPtr Func = nullptr;
+
+	explicit operator bool() const { return Thunk != nullptr; }
+	void operator()(UObject* self, ExpressionValue* Args) const { Thunk(Func, self, Args); }
+};
+
+// Evaluates a primitive operator directly on its already evaluated arguments
+typedef ExpressionValue(*NativeIntrinsic)(ExpressionValue* Args);
 
 class NativeFunctions
 {
@@ -15,207 +29,233 @@ public:
 	static std::vector<UFunction*> FuncByIndex;
 	static std::vector<NativeFuncHandler> NativeByIndex;
 	static std::map<std::pair<NameString, NameString>, NativeFuncHandler> NativeByName;
+	static std::vector<NativeIntrinsic> IntrinsicByIndex;
 
 	static void RegisterHandler(const NameString& className, const NameString& funcName, int nativeIndex, NativeFuncHandler handler);
 	static void RegisterNativeFunc(UFunction* func);
+	static void RegisterIntrinsic(int nativeIndex, NativeIntrinsic intrinsic);
+};
+
+inline ExpressionValue IntrinsicResult(uint8_t value) { return ExpressionValue::ByteValue(value); }
+inline ExpressionValue IntrinsicResult(int32_t value) { return ExpressionValue::IntValue(value); }
+inline ExpressionValue IntrinsicResult(bool value) { return ExpressionValue::BoolValue(value); }
+inline ExpressionValue IntrinsicResult(float value) { return ExpressionValue::FloatValue(value); }
+inline ExpressionValue IntrinsicResult(const vec3& value) { return ExpressionValue::VectorValue(value); }
+inline ExpressionValue IntrinsicResult(const Rotator& value) { return ExpressionValue::RotatorValue(value); }
+inline ExpressionValue IntrinsicResult(std::string&& value) { return ExpressionValue::StringValue(std::move(value)); }
+
+// Generates an intrinsic from a native operator implementation of the form void(A, R& ReturnValue) or void(A, B, R& ReturnValue)
+template<auto Func> struct NativeIntrinsicThunk;
+
+template<typename A, typename R, void(*Func)(A, R&)>
+struct NativeIntrinsicThunk<Func>
+{
+	static ExpressionValue Eval(ExpressionValue* Args)
+	{
+		R result = {};
+		Func(Args[0].ToType<A>(), result);
+		return IntrinsicResult(std::move(result));
+	}
+
+	// Direct call used by CompiledScript code
+	static R Call(A a)
+	{
+		R result = {};
+		Func(a, result);
+		return result;
+	}
 };
 
+template<typename A, typename B, typename R, void(*Func)(A, B, R&)>
+struct NativeIntrinsicThunk<Func>
+{
+	static ExpressionValue Eval(ExpressionValue* Args)
+	{
+		R result = {};
+		Func(Args[0].ToType<A>(), Args[1].ToType<B>(), result);
+		return IntrinsicResult(std::move(result));
+	}
+
+	static R Call(A a, B b)
+	{
+		R result = {};
+		Func(a, b, result);
+		return result;
+	}
+};
+
+template<auto Func>
+void RegisterVMIntrinsic(int nativeIndex)
+{
+	NativeFunctions::RegisterIntrinsic(nativeIndex, &NativeIntrinsicThunk<Func>::Eval);
+}
+
+template<typename... T, size_t... I>
+void CallStaticNativeFunc(void(*func)(T...), ExpressionValue* Args, std::index_sequence<I...>)
+{
+	func(Args[I].template ToType<T>()...);
+}
+
+template<typename... T, size_t... I>
+void CallInstanceNativeFunc(void(*func)(UObject* self, T...), UObject* self, ExpressionValue* Args, std::index_sequence<I...>)
+{
+	func(self, Args[I].template ToType<T>()...);
+}
+
+template<typename... T>
+void StaticNativeFuncThunk(NativeFuncPtr func, UObject* self, ExpressionValue* Args)
+{
+	CallStaticNativeFunc(reinterpret_cast<void(*)(T...)>(func), Args, std::index_sequence_for<T...>());
+}
+
+template<typename... T>
+void InstanceNativeFuncThunk(NativeFuncPtr func, UObject* self, ExpressionValue* Args)
+{
+	CallInstanceNativeFunc(reinterpret_cast<void(*)(UObject*, T...)>(func), self, Args, std::index_sequence_for<T...>());
+}
+
+template<typename... T>
+void RegisterStaticNativeFunc(const std::string& className, const std::string& funcName, void(*func)(T...), int nativeIndex)
+{
+	NativeFunctions::RegisterHandler(className, funcName, nativeIndex, { &StaticNativeFuncThunk<T...>, reinterpret_cast<NativeFuncPtr>(func) });
+}
+
+template<typename... T>
+void RegisterInstanceNativeFunc(const std::string& className, const std::string& funcName, void(*func)(UObject* self, T...), int nativeIndex)
+{
+	NativeFunctions::RegisterHandler(className, funcName, nativeIndex, { &InstanceNativeFuncThunk<T...>, reinterpret_cast<NativeFuncPtr>(func) });
+}
+
 // Static native functions:
 
 inline void RegisterVMNativeFunc_0(const std::string& className, const std::string& funcName, void(*func)(), int nativeIndex)
 {
-	NativeFunctions::RegisterHandler(className, funcName, nativeIndex, [=](UObject* self, ExpressionValue* Args)
-	{
-		func();
-	});
+	RegisterStaticNativeFunc(className, funcName, func, nativeIndex);
 }
 
 template<typename Arg1>
 void RegisterVMNativeFunc_1(const std::string& className, const std::string& funcName, void(*func)(Arg1 arg1), int nativeIndex)
 {
-	NativeFunctions::RegisterHandler(className, funcName, nativeIndex, [=](UObject* self, ExpressionValue* Args)
-	{
-		func(Args[0].ToType<Arg1>());
-	});
+	RegisterStaticNativeFunc(className, funcName, func, nativeIndex);
 }
 
 template<typename Arg1, typename Arg2>
 void RegisterVMNativeFunc_2(const std::string& className, const std::string& funcName, void(*func)(Arg1 arg1, Arg2 arg2), int nativeIndex)
 {
-	NativeFunctions::RegisterHandler(className, funcName, nativeIndex, [=](UObject* self, ExpressionValue* Args)
-	{
-		func(Args[0].ToType<Arg1>(), Args[1].ToType<Arg2>());
-	});
+	RegisterStaticNativeFunc(className, funcName, func, nativeIndex);
 }
 
 template<typename Arg1, typename Arg2, typename Arg3>
 void RegisterVMNativeFunc_3(const std::string& className, const std::string& funcName, void(*func)(Arg1 arg1, Arg2 arg2, Arg3 arg3), int nativeIndex)
 {
-	NativeFunctions::RegisterHandler(className, funcName, nativeIndex, [=](UObject* self, ExpressionValue* Args)
-	{
-		func(Args[0].ToType<Arg1>(), Args[1].ToType<Arg2>(), Args[2].ToType<Arg3>());
-	});
+	RegisterStaticNativeFunc(className, funcName, func, nativeIndex);
 }
 
 template<typename Arg1, typename Arg2, typename Arg3, typename Arg4>
 void RegisterVMNativeFunc_4(const std::string& className, const std::string& funcName, void(*func)(Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4), int nativeIndex)
 {
-	NativeFunctions::RegisterHandler(className, funcName, nativeIndex, [=](UObject* self, ExpressionValue* Args)
-	{
-		func(Args[0].ToType<Arg1>(), Args[1].ToType<Arg2>(), Args[2].ToType<Arg3>(), Args[3].ToType<Arg4>());
-	});
+	RegisterStaticNativeFunc(className, funcName, func, nativeIndex);
 }
 
 template<typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5>
 void RegisterVMNativeFunc_5(const std::string& className, const std::string& funcName, void(*func)(Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5), int nativeIndex)
 {
-	NativeFunctions::RegisterHandler(className, funcName, nativeIndex, [=](UObject* self, ExpressionValue* Args)
-	{
-		func(Args[0].ToType<Arg1>(), Args[1].ToType<Arg2>(), Args[2].ToType<Arg3>(), Args[3].ToType<Arg4>(), Args[4].ToType<Arg5>());
-	});
+	RegisterStaticNativeFunc(className, funcName, func, nativeIndex);
 }
 
 template<typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6>
 void RegisterVMNativeFunc_6(const std::string& className, const std::string& funcName, void(*func)(Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5, Arg6 arg6), int nativeIndex)
 {
-	NativeFunctions::RegisterHandler(className, funcName, nativeIndex, [=](UObject* self, ExpressionValue* Args)
-	{
-		func(Args[0].ToType<Arg1>(), Args[1].ToType<Arg2>(), Args[2].ToType<Arg3>(), Args[3].ToType<Arg4>(), Args[4].ToType<Arg5>(), Args[5].ToType<Arg6>());
-	});
+	RegisterStaticNativeFunc(className, funcName, func, nativeIndex);
 }
 
 template<typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6, typename Arg7>
 void RegisterVMNativeFunc_7(const std::string& className, const std::string& funcName, void(*func)(Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5, Arg6 arg6, Arg7 arg7), int nativeIndex)
 {
-	NativeFunctions::RegisterHandler(className, funcName, nativeIndex, [=](UObject* self, ExpressionValue* Args)
-	{
-		func(Args[0].ToType<Arg1>(), Args[1].ToType<Arg2>(), Args[2].ToType<Arg3>(), Args[3].ToType<Arg4>(), Args[4].ToType<Arg5>(), Args[5].ToType<Arg6>(), Args[6].ToType<Arg7>());
-	});
+	RegisterStaticNativeFunc(className, funcName, func, nativeIndex);
 }
 
 template<typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6, typename Arg7, typename Arg8>
 void RegisterVMNativeFunc_8(const std::string& className, const std::string& funcName, void(*func)(Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5, Arg6 arg6, Arg7 arg7, Arg8 arg8), int nativeIndex)
 {
-	NativeFunctions::RegisterHandler(className, funcName, nativeIndex, [=](UObject* self, ExpressionValue* Args)
-	{
-		func(Args[0].ToType<Arg1>(), Args[1].ToType<Arg2>(), Args[2].ToType<Arg3>(), Args[3].ToType<Arg4>(), Args[4].ToType<Arg5>(), Args[5].ToType<Arg6>(), Args[6].ToType<Arg7>(), Args[7].ToType<Arg8>());
-	});
+	RegisterStaticNativeFunc(className, funcName, func, nativeIndex);
 }
 
 template<typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6, typename Arg7, typename Arg8, typename Arg9>
 void RegisterVMNativeFunc_9(const std::string& className, const std::string& funcName, void(*func)(Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5, Arg6 arg6, Arg7 arg7, Arg8 arg8, Arg9 arg9), int nativeIndex)
 {
-	NativeFunctions::RegisterHandler(className, funcName, nativeIndex, [=](UObject* self, ExpressionValue* Args)
-	{
-		func(Args[0].ToType<Arg1>(), Args[1].ToType<Arg2>(), Args[2].ToType<Arg3>(), Args[3].ToType<Arg4>(), Args[4].ToType<Arg5>(), Args[5].ToType<Arg6>(), Args[6].ToType<Arg7>(), Args[7].ToType<Arg8>(), Args[8].ToType<Arg9>());
-	});
+	RegisterStaticNativeFunc(className, funcName, func, nativeIndex);
 }
 
 template<typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6, typename Arg7, typename Arg8, typename Arg9, typename Arg10>
 void RegisterVMNativeFunc_10(const std::string& className, const std::string& funcName, void(*func)(Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5, Arg6 arg6, Arg7 arg7, Arg8 arg8, Arg9 arg9, Arg10 arg10), int nativeIndex)
 {
-	NativeFunctions::RegisterHandler(className, funcName, nativeIndex, [=](UObject* self, ExpressionValue* Args)
-	{
-		func(Args[0].ToType<Arg1>(), Args[1].ToType<Arg2>(), Args[2].ToType<Arg3>(), Args[3].ToType<Arg4>(), Args[4].ToType<Arg5>(), Args[5].ToType<Arg6>(), Args[6].ToType<Arg7>(), Args[7].ToType<Arg8>(), Args[8].ToType<Arg9>(), Args[9].ToType<Arg10>());
-	});
+	RegisterStaticNativeFunc(className, funcName, func, nativeIndex);
 }
 
 // Instance native functions:
 
 inline void RegisterVMNativeFunc_0(const std::string& className, const std::string& funcName, void(*func)(UObject* self), int nativeIndex)
 {
-	NativeFunctions::RegisterHandler(className, funcName, nativeIndex, [=](UObject* self, ExpressionValue* Args)
-	{
-		func(self);
-	});
+	RegisterInstanceNativeFunc(className, funcName, func, nativeIndex);
 }
 
 template<typename Arg1>
 void RegisterVMNativeFunc_1(const std::string& className, const std::string& funcName, void(*func)(UObject* self, Arg1 arg1), int nativeIndex)
 {
-	NativeFunctions::RegisterHandler(className, funcName, nativeIndex, [=](UObject* self, ExpressionValue* Args)
-	{
-		func(self, Args[0].ToType<Arg1>());
-	});
+	RegisterInstanceNativeFunc(className, funcName, func, nativeIndex);
 }
 
 template<typename Arg1, typename Arg2>
 void RegisterVMNativeFunc_2(const std::string& className, const std::string& funcName, void(*func)(UObject* self, Arg1 arg1, Arg2 arg2), int nativeIndex)
 {
-	NativeFunctions::RegisterHandler(className, funcName, nativeIndex, [=](UObject* self, ExpressionValue* Args)
-	{
-		func(self, Args[0].ToType<Arg1>(), Args[1].ToType<Arg2>());
-	});
+	RegisterInstanceNativeFunc(className, funcName, func, nativeIndex);
 }
 
 template<typename Arg1, typename Arg2, typename Arg3>
 void RegisterVMNativeFunc_3(const std::string& className, const std::string& funcName, void(*func)(UObject* self, Arg1 arg1, Arg2 arg2, Arg3 arg3), int nativeIndex)
 {
-	NativeFunctions::RegisterHandler(className, funcName, nativeIndex, [=](UObject* self, ExpressionValue* Args)
-	{
-		func(self, Args[0].ToType<Arg1>(), Args[1].ToType<Arg2>(), Args[2].ToType<Arg3>());
-	});
+	RegisterInstanceNativeFunc(className, funcName, func, nativeIndex);
 }
 
 template<typename Arg1, typename Arg2, typename Arg3, typename Arg4>
 void RegisterVMNativeFunc_4(const std::string& className, const std::string& funcName, void(*func)(UObject* self, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4), int nativeIndex)
 {
-	NativeFunctions::RegisterHandler(className, funcName, nativeIndex, [=](UObject* self, ExpressionValue* Args)
-	{
-		func(self, Args[0].ToType<Arg1>(), Args[1].ToType<Arg2>(), Args[2].ToType<Arg3>(), Args[3].ToType<Arg4>());
-	});
+	RegisterInstanceNativeFunc(className, funcName, func, nativeIndex);
 }
 
 template<typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5>
 void RegisterVMNativeFunc_5(const std::string& className, const std::string& funcName, void(*func)(UObject* self, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5), int nativeIndex)
 {
-	NativeFunctions::RegisterHandler(className, funcName, nativeIndex, [=](UObject* self, ExpressionValue* Args)
-	{
-		func(self, Args[0].ToType<Arg1>(), Args[1].ToType<Arg2>(), Args[2].ToType<Arg3>(), Args[3].ToType<Arg4>(), Args[4].ToType<Arg5>());
-	});
+	RegisterInstanceNativeFunc(className, funcName, func, nativeIndex);
 }
 
 template<typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6>
 void RegisterVMNativeFunc_6(const std::string& className, const std::string& funcName, void(*func)(UObject* self, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5, Arg6 arg6), int nativeIndex)
 {
-	NativeFunctions::RegisterHandler(className, funcName, nativeIndex, [=](UObject* self, ExpressionValue* Args)
-	{
-		func(self, Args[0].ToType<Arg1>(), Args[1].ToType<Arg2>(), Args[2].ToType<Arg3>(), Args[3].ToType<Arg4>(), Args[4].ToType<Arg5>(), Args[5].ToType<Arg6>());
-	});
+	RegisterInstanceNativeFunc(className, funcName, func, nativeIndex);
 }
 
 template<typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6, typename Arg7>
 void RegisterVMNativeFunc_7(const std::string& className, const std::string& funcName, void(*func)(UObject* self, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5, Arg6 arg6, Arg7 arg7), int nativeIndex)
 {
-	NativeFunctions::RegisterHandler(className, funcName, nativeIndex, [=](UObject* self, ExpressionValue* Args)
-	{
-		func(self, Args[0].ToType<Arg1>(), Args[1].ToType<Arg2>(), Args[2].ToType<Arg3>(), Args[3].ToType<Arg4>(), Args[4].ToType<Arg5>(), Args[5].ToType<Arg6>(), Args[6].ToType<Arg7>());
-	});
+	RegisterInstanceNativeFunc(className, funcName, func, nativeIndex);
 }
 
 template<typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6, typename Arg7, typename Arg8>
 void RegisterVMNativeFunc_8(const std::string& className, const std::string& funcName, void(*func)(UObject* self, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5, Arg6 arg6, Arg7 arg7, Arg8 arg8), int nativeIndex)
 {
-	NativeFunctions::RegisterHandler(className, funcName, nativeIndex, [=](UObject* self, ExpressionValue* Args)
-	{
-		func(self, Args[0].ToType<Arg1>(), Args[1].ToType<Arg2>(), Args[2].ToType<Arg3>(), Args[3].ToType<Arg4>(), Args[4].ToType<Arg5>(), Args[5].ToType<Arg6>(), Args[6].ToType<Arg7>(), Args[7].ToType<Arg8>());
-	});
+	RegisterInstanceNativeFunc(className, funcName, func, nativeIndex);
 }
 
 template<typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6, typename Arg7, typename Arg8, typename Arg9>
 void RegisterVMNativeFunc_9(const std::string& className, const std::string& funcName, void(*func)(UObject* self, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5, Arg6 arg6, Arg7 arg7, Arg8 arg8, Arg9 arg9), int nativeIndex)
 {
-	NativeFunctions::RegisterHandler(className, funcName, nativeIndex, [=](UObject* self, ExpressionValue* Args)
-	{
-		func(self, Args[0].ToType<Arg1>(), Args[1].ToType<Arg2>(), Args[2].ToType<Arg3>(), Args[3].ToType<Arg4>(), Args[4].ToType<Arg5>(), Args[5].ToType<Arg6>(), Args[6].ToType<Arg7>(), Args[7].ToType<Arg8>(), Args[8].ToType<Arg9>());
-	});
+	RegisterInstanceNativeFunc(className, funcName, func, nativeIndex);
 }
 
 template<typename Arg1, typename Arg2, typename Arg3, typename Arg4, typename Arg5, typename Arg6, typename Arg7, typename Arg8, typename Arg9, typename Arg10>
 void RegisterVMNativeFunc_10(const std::string& className, const std::string& funcName, void(*func)(UObject* self, Arg1 arg1, Arg2 arg2, Arg3 arg3, Arg4 arg4, Arg5 arg5, Arg6 arg6, Arg7 arg7, Arg8 arg8, Arg9 arg9, Arg10 arg10), int nativeIndex)
 {
-	NativeFunctions::RegisterHandler(className, funcName, nativeIndex, [=](UObject* self, ExpressionValue* Args)
-	{
-		func(self, Args[0].ToType<Arg1>(), Args[1].ToType<Arg2>(), Args[2].ToType<Arg3>(), Args[3].ToType<Arg4>(), Args[4].ToType<Arg5>(), Args[5].ToType<Arg6>(), Args[6].ToType<Arg7>(), Args[7].ToType<Arg8>(), Args[8].ToType<Arg9>(), Args[9].ToType<Arg10>());
-	});
+	RegisterInstanceNativeFunc(className, funcName, func, nativeIndex);
 }
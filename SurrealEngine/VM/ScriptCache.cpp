@@ -0,0 +1,167 @@
+
+#include "Precomp.h"
+#include "ScriptCache.h"
+#include "File.h"
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+namespace
+{
+	const uint32_t CacheSignature = 0x43534553; // 'SESC'
+
+	class CacheReader
+	{
+	public:
+		CacheReader(const std::vector<uint8_t>& data) : data(data) { }
+
+		void Read(void* d, size_t s)
+		{
+			if (pos + s > data.size())
+				throw std::runtime_error("Unexpected end of script cache");
+			memcpy(d, data.data() + pos, s);
+			pos += s;
+		}
+
+		uint32_t ReadUInt32() { uint32_t v; Read(&v, sizeof(v)); return v; }
+		int64_t ReadInt64() { int64_t v; Read(&v, sizeof(v)); return v; }
+
+		size_t Tell() const { return pos; }
+
+	private:
+		const std::vector<uint8_t>& data;
+		size_t pos = 0;
+	};
+
+	void Write(std::vector<uint8_t>& buffer, const void* d, size_t s)
+	{
+		buffer.insert(buffer.end(), (const uint8_t*)d, (const uint8_t*)d + s);
+	}
+
+	void WriteUInt32(std::vector<uint8_t>& buffer, uint32_t v) { Write(buffer, &v, sizeof(v)); }
+	void WriteInt64(std::vector<uint8_t>& buffer, int64_t v) { Write(buffer, &v, sizeof(v)); }
+}
+
+ScriptCache::ScriptCache(const std::string& filename, const uint8_t* guid, int64_t timestamp) : Filename(filename), Timestamp(timestamp)
+{
+	memcpy(Guid, guid, sizeof(Guid));
+	Load();
+}
+
+bool ScriptCache::Find(uint32_t offset, uint32_t scriptSize, uint32_t& diskSize, std::vector<uint8_t>& bytecode) const
+{
+	auto it = Entries.find(offset);
+	if (it == Entries.end() || it->second.DataSize != scriptSize)
+		return false;
+
+	const Entry& entry = it->second;
+	diskSize = entry.DiskSize;
+	bytecode.assign(Data.begin() + entry.DataOffset, Data.begin() + entry.DataOffset + entry.DataSize);
+	return true;
+}
+
+void ScriptCache::Add(uint32_t offset, uint32_t diskSize, const std::vector<uint8_t>& bytecode)
+{
+	Entry entry;
+	entry.DiskSize = diskSize;
+	entry.DataOffset = (uint32_t)Data.size();
+	entry.DataSize = (uint32_t)bytecode.size();
+	Data.insert(Data.end(), bytecode.begin(), bytecode.end());
+	Entries[offset] = entry;
+	Dirty = true;
+}
+
+void ScriptCache::Load()
+{
+	std::vector<uint8_t> buffer;
+	try
+	{
+		buffer = File::read_all_bytes(Filename);
+	}
+	catch (...)
+	{
+		return;
+	}
+
+	try
+	{
+		CacheReader reader(buffer);
+		if (reader.ReadUInt32() != CacheSignature || reader.ReadUInt32() != FormatVersion)
+			return;
+
+		uint8_t guid[16];
+		reader.Read(guid, sizeof(guid));
+		if (memcmp(guid, Guid, sizeof(Guid)) != 0 || reader.ReadInt64() != Timestamp)
+			return;
+
+		uint32_t count = reader.ReadUInt32();
+		uint32_t dataSize = reader.ReadUInt32();
+
+		std::unordered_map<uint32_t, Entry> entries;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			uint32_t offset = reader.ReadUInt32();
+			Entry entry;
+			entry.DiskSize = reader.ReadUInt32();
+			entry.DataOffset = reader.ReadUInt32();
+			entry.DataSize = reader.ReadUInt32();
+			if ((uint64_t)entry.DataOffset + entry.DataSize > dataSize)
+				return;
+			entries[offset] = entry;
+		}
+
+		if (buffer.size() - reader.Tell() != dataSize)
+			return;
+
+		Data.assign(buffer.begin() + reader.Tell(), buffer.end());
+		Entries = std::move(entries);
+	}
+	catch (...)
+	{
+		// A damaged cache file is treated as a missing one
+		Entries.clear();
+		Data.clear();
+	}
+}
+
+void ScriptCache::Save()
+{
+	if (!Dirty)
+		return;
+
+	std::vector<uint8_t> buffer;
+	WriteUInt32(buffer, CacheSignature);
+	WriteUInt32(buffer, FormatVersion);
+	Write(buffer, Guid, sizeof(Guid));
+	WriteInt64(buffer, Timestamp);
+	WriteUInt32(buffer, (uint32_t)Entries.size());
+	WriteUInt32(buffer, (uint32_t)Data.size());
+	for (const auto& it : Entries)
+	{
+		WriteUInt32(buffer, it.first);
+		WriteUInt32(buffer, it.second.DiskSize);
+		WriteUInt32(buffer, it.second.DataOffset);
+		WriteUInt32(buffer, it.second.DataSize);
+	}
+	Write(buffer, Data.data(), Data.size());
+
+	// Write to a temporary file first so that other instances sharing the cache folder never see a partial file
+	std::string tempFilename = Filename + "." + std::to_string(std::random_device()()) + ".tmp";
+	try
+	{
+		File::write_all_bytes(tempFilename, buffer.data(), buffer.size());
+	}
+	catch (...)
+	{
+		return;
+	}
+
+	if (std::rename(tempFilename.c_str(), Filename.c_str()) != 0)
+	{
+		std::remove(Filename.c_str());
+		if (std::rename(tempFilename.c_str(), Filename.c_str()) != 0)
+			std::remove(tempFilename.c_str());
+	}
+
+	Dirty = false;
+}
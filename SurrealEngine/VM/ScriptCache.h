@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Persistent per-package cache of the script bytecode read by UStruct::Load.
+// This only skips UStruct::ReadToken walking the serialized script. Bytecode decoding, constant folding and lowering still run when a function is first used.
+// Entries are keyed by the file offset of the script in the package and only hold package relative name and object indices.
+// The cache file is discarded if the package GUID or modification time no longer match.
+class ScriptCache
+{
+public:
+	ScriptCache(const std::string& filename, const uint8_t* guid, int64_t timestamp);
+
+	bool Find(uint32_t offset, uint32_t scriptSize, uint32_t& diskSize, std::vector<uint8_t>& bytecode) const;
+	void Add(uint32_t offset, uint32_t diskSize, const std::vector<uint8_t>& bytecode);
+
+	void Save();
+
+private:
+	void Load();
+
+	struct Entry
+	{
+		uint32_t DiskSize = 0;
+		uint32_t DataOffset = 0;
+		uint32_t DataSize = 0;
+	};
+
+	// Bump this whenever the bytecode written by UStruct::ReadToken changes
+	enum { FormatVersion = 1 };
+
+	std::string Filename;
+	uint8_t Guid[16] = {};
+	int64_t Timestamp = 0;
+
+	std::unordered_map<uint32_t, Entry> Entries;
+	std::vector<uint8_t> Data;
+	bool Dirty = false;
+};
@@ -10,7 +10,7 @@ ExpressionValue CallEvent(UObject* Context, const NameString& name, std::vector<
 
 	UFunction* func = FindEventFunction(Context, name);
 	if (func)
-		return Frame::Call(func, Context, std::move(args));
+		return Frame::Call(func, Context, args);
 	else
 		return ExpressionValue::NothingValue(); // throw std::runtime_error("Event " + name + " not found on object");
 }
@@ -19,33 +19,14 @@ UFunction* FindEventFunction(UObject* Context, const NameString& name)
 {
 	// Search states first
 
-	NameString stateName = Context->GetStateName();
-	if (!stateName.IsNone())
+	if (Context->StateFrame && Context->StateFrame->Func)
 	{
-		for (UClass* cls = Context->Class; cls != nullptr; cls = static_cast<UClass*>(cls->BaseStruct))
-		{
-			UState* state = cls->GetState(stateName);
-			if (state)
-			{
-				UFunction* func = state->GetFunction(name);
-				if (func)
-				{
-					return func;
-				}
-			}
-		}
-	}
-
-	// Search normal member functions next
-
-	for (UClass* cls = Context->Class; cls != nullptr; cls = static_cast<UClass*>(cls->BaseStruct))
-	{
-		UFunction* func = cls->GetFunction(name);
+		UFunction* func = Context->Class->FindStateFunction(Context->StateFrame->Func->Name, name);
 		if (func)
-		{
 			return func;
-		}
 	}
 
-	return nullptr;
+	// Search normal member functions next
+
+	return Context->Class->FindFunction(name);
 }
@@ -0,0 +1,232 @@
+
+#include "Precomp.h"
+#include "ScriptProfiler.h"
+#include "NativeFunc.h"
+#include "UObject/UClass.h"
+#include "File.h"
+#include "UI/Core/JsonValue.h"
+#include <algorithm>
+#include <unordered_map>
+
+namespace
+{
+	struct FunctionStats
+	{
+		uint64_t Calls = 0;
+		int64_t InclusiveTime = 0;
+		int64_t ExclusiveTime = 0;
+		int ActiveCount = 0;
+	};
+
+	struct StackEntry
+	{
+		UStruct* Func = nullptr;
+		ScriptProfiler::Clock::time_point Start;
+		int64_t ChildTime = 0;
+	};
+
+	struct TraceEvent
+	{
+		UStruct* Func = nullptr;
+		int64_t Start = 0;
+		int64_t Duration = 0;
+	};
+
+	struct ProfilerData
+	{
+		std::unordered_map<UStruct*, FunctionStats> Functions;
+		std::vector<uint64_t> NativeCalls;
+		std::vector<StackEntry> Stack;
+		std::vector<TraceEvent> TraceEvents;
+		ScriptProfiler::Clock::time_point StartTime;
+	};
+
+	// Stop recording trace events past this point to keep memory use bounded
+	const size_t MaxTraceEvents = 1'000'000;
+
+	ProfilerData& GetData()
+	{
+		static ProfilerData data;
+		return data;
+	}
+
+	int64_t ToNanoseconds(ScriptProfiler::Clock::duration d)
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+	}
+
+	std::string FormatMs(int64_t ns)
+	{
+		char buffer[64];
+		snprintf(buffer, sizeof(buffer), "%10.3f", ns / 1'000'000.0);
+		return buffer;
+	}
+}
+
+bool ScriptProfiler::Enabled = false;
+
+void ScriptProfiler::Start()
+{
+	ProfilerData& data = GetData();
+	if (data.Functions.empty() && data.TraceEvents.empty())
+		data.StartTime = Clock::now();
+	Enabled = true;
+}
+
+void ScriptProfiler::Stop()
+{
+	Enabled = false;
+}
+
+void ScriptProfiler::Reset()
+{
+	ProfilerData& data = GetData();
+	data.Functions.clear();
+	data.NativeCalls.clear();
+	data.TraceEvents.clear();
+	data.StartTime = Clock::now();
+
+	// Reset runs from script, so keep the calls still on the stack and only count their time from here on
+	for (StackEntry& entry : data.Stack)
+	{
+		data.Functions[entry.Func].ActiveCount++;
+		entry.Start = data.StartTime;
+		entry.ChildTime = 0;
+	}
+}
+
+void ScriptProfiler::Enter(UStruct* func)
+{
+	ProfilerData& data = GetData();
+	FunctionStats& stats = data.Functions[func];
+	stats.Calls++;
+	stats.ActiveCount++;
+
+	StackEntry entry;
+	entry.Func = func;
+	entry.Start = Clock::now();
+	data.Stack.push_back(entry);
+}
+
+void ScriptProfiler::Leave()
+{
+	ProfilerData& data = GetData();
+	if (data.Stack.empty())
+		return;
+
+	StackEntry entry = data.Stack.back();
+	data.Stack.pop_back();
+
+	auto end = Clock::now();
+	int64_t duration = ToNanoseconds(end - entry.Start);
+
+	FunctionStats& stats = data.Functions[entry.Func];
+	stats.ActiveCount--;
+	stats.ExclusiveTime += duration - entry.ChildTime;
+	if (stats.ActiveCount == 0) // Only count the outermost call of recursive functions
+		stats.InclusiveTime += duration;
+
+	if (!data.Stack.empty())
+		data.Stack.back().ChildTime += duration;
+
+	if (data.TraceEvents.size() < MaxTraceEvents)
+	{
+		TraceEvent e;
+		e.Func = entry.Func;
+		e.Start = ToNanoseconds(entry.Start - data.StartTime);
+		e.Duration = duration;
+		data.TraceEvents.push_back(e);
+	}
+}
+
+void ScriptProfiler::NativeCall(int nativeIndex)
+{
+	ProfilerData& data = GetData();
+	if (data.NativeCalls.size() <= (size_t)nativeIndex)
+		data.NativeCalls.resize((size_t)nativeIndex + 1);
+	data.NativeCalls[nativeIndex]++;
+}
+
+std::string ScriptProfiler::GetDisplayName(UStruct* func)
+{
+	if (!func)
+		return "None";
+
+	std::string name = func->Name.ToString();
+	for (UStruct* parent = func->StructParent; parent != nullptr; parent = parent->StructParent)
+		name = parent->Name.ToString() + "." + name;
+	return name;
+}
+
+std::string ScriptProfiler::Report(size_t maxEntries)
+{
+	ProfilerData& data = GetData();
+
+	std::vector<std::pair<UStruct*, FunctionStats>> sorted(data.Functions.begin(), data.Functions.end());
+	std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) { return a.second.ExclusiveTime > b.second.ExclusiveTime; });
+
+	std::string report;
+	report += "  Exclusive ms  Inclusive ms       Calls  Function\n";
+	for (size_t i = 0; i < sorted.size() && i < maxEntries; i++)
+	{
+		const FunctionStats& stats = sorted[i].second;
+		char calls[32];
+		snprintf(calls, sizeof(calls), "%12llu", (unsigned long long)stats.Calls);
+		report += "  " + FormatMs(stats.ExclusiveTime) + "    " + FormatMs(stats.InclusiveTime) + calls + "  " + GetDisplayName(sorted[i].first) + "\n";
+	}
+
+	std::vector<std::pair<int, uint64_t>> natives;
+	for (size_t i = 0; i < data.NativeCalls.size(); i++)
+	{
+		if (data.NativeCalls[i] != 0)
+			natives.push_back({ (int)i, data.NativeCalls[i] });
+	}
+	std::sort(natives.begin(), natives.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+
+	if (!natives.empty())
+	{
+		report += "\n         Calls  Native\n";
+		for (size_t i = 0; i < natives.size() && i < maxEntries; i++)
+		{
+			int index = natives[i].first;
+			UFunction* func = (size_t)index < NativeFunctions::FuncByIndex.size() ? NativeFunctions::FuncByIndex[index] : nullptr;
+			char calls[32];
+			snprintf(calls, sizeof(calls), "%14llu", (unsigned long long)natives[i].second);
+			report += std::string(calls) + "  " + std::to_string(index) + " " + (func ? GetDisplayName(func) : std::string("?")) + "\n";
+		}
+	}
+
+	return report;
+}
+
+void ScriptProfiler::WriteReport(const std::string& filename)
+{
+	File::write_all_text(filename, Report(std::string::npos));
+}
+
+void ScriptProfiler::WriteChromeTrace(const std::string& filename)
+{
+	ProfilerData& data = GetData();
+
+	// Names are stored as quoted and escaped JSON strings
+	std::unordered_map<UStruct*, std::string> names;
+	std::string json = "{\"traceEvents\":[\n";
+	bool first = true;
+	for (const TraceEvent& e : data.TraceEvents)
+	{
+		std::string& name = names[e.Func];
+		if (name.empty())
+			name = JsonValue::string(GetDisplayName(e.Func)).to_json();
+
+		char buffer[128];
+		snprintf(buffer, sizeof(buffer), ",\"cat\":\"script\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1}", e.Start / 1000.0, e.Duration / 1000.0);
+
+		if (!first)
+			json += ",\n";
+		json += "{\"name\":" + name + buffer;
+		first = false;
+	}
+	json += "\n]}\n";
+
+	File::write_all_text(filename, json);
+}
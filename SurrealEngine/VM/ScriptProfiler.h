@@ -0,0 +1,54 @@
+#pragma once
+
+#include <chrono>
+
+class UStruct;
+class UFunction;
+
+// Opt-in instrumenting profiler for script code. Controlled with the 'scriptprofile' console command.
+class ScriptProfiler
+{
+public:
+	static bool Enabled;
+
+	static void Start();
+	static void Stop();
+	static void Reset();
+
+	static void Enter(UStruct* func);
+	static void Leave();
+	static void NativeCall(int nativeIndex);
+
+	static std::string Report(size_t maxEntries = 50);
+	static void WriteReport(const std::string& filename);
+	static void WriteChromeTrace(const std::string& filename);
+
+	static std::string GetDisplayName(UStruct* func);
+
+	typedef std::chrono::steady_clock Clock;
+};
+
+class ScriptProfilerScope
+{
+public:
+	ScriptProfilerScope(UStruct* func)
+	{
+		if (ScriptProfiler::Enabled)
+		{
+			Active = true;
+			ScriptProfiler::Enter(func);
+		}
+	}
+
+	~ScriptProfilerScope()
+	{
+		if (Active)
+			ScriptProfiler::Leave();
+	}
+
+private:
+	ScriptProfilerScope(const ScriptProfilerScope&) = delete;
+	ScriptProfilerScope& operator=(const ScriptProfilerScope&) = delete;
+
+	bool Active = false;
+};
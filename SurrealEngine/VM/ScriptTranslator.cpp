@@ -0,0 +1,520 @@
+
+#include "Precomp.h"
+#include "ScriptTranslator.h"
+#include "Bytecode.h"
+#include "NativeFunc.h"
+#include "Package/PackageManager.h"
+#include "UObject/UActor.h"
+#include "UObject/UClass.h"
+#include "UObject/UProperty.h"
+#include <cmath>
+
+std::string ScriptTranslator::Run(PackageManager* packages, const std::string& names)
+{
+	ScriptTranslator translator;
+
+	size_t start = 0;
+	while (start < names.size())
+	{
+		size_t end = names.find(',', start);
+		if (end == std::string::npos)
+			end = names.size();
+		std::string name = names.substr(start, end - start);
+		start = end + 1;
+		if (name.empty())
+			continue;
+
+		size_t dot = name.find('.');
+		Package* package = packages->GetPackage(name.substr(0, dot));
+		if (dot == std::string::npos)
+		{
+			for (UClass* cls : package->GetAllClasses())
+				translator.AddClass(package, cls);
+		}
+		else
+		{
+			UClass* cls = UObject::TryCast<UClass>(package->GetUObject("Class", name.substr(dot + 1)));
+			if (!cls)
+				throw std::runtime_error("Could not find class " + name);
+			translator.AddClass(package, cls);
+		}
+	}
+
+	std::string output;
+	output += "// Generated by SurrealEngine --translate-script. Do not edit.\r\n";
+	output += "\r\n";
+	output += "#include \"Precomp.h\"\r\n";
+	output += "#include \"VM/CompiledScript.h\"\r\n";
+	output += "#include \"VM/Frame.h\"\r\n";
+	output += "#include \"VM/Bytecode.h\"\r\n";
+	output += "#include \"VM/ExpressionEvaluator.h\"\r\n";
+	output += "#include \"VM/NativeFunc.h\"\r\n";
+	output += "#include \"Native/NObject.h\"\r\n";
+	output += "\r\n";
+	output += "namespace\r\n{\r\n";
+	output += translator.Functions;
+	output += "}\r\n\r\n";
+	output += translator.Registrations;
+	return output;
+}
+
+void ScriptTranslator::AddClass(Package* package, UClass* cls)
+{
+	for (UField* child = cls->Children; child != nullptr; child = child->Next)
+	{
+		if (UFunction* func = UObject::TryCast<UFunction>(child))
+		{
+			AddFunction(package, func);
+		}
+		else if (UState* state = UObject::TryCast<UState>(child))
+		{
+			AddFunction(package, state);
+			for (UField* stateChild = state->Children; stateChild != nullptr; stateChild = stateChild->Next)
+			{
+				if (UFunction* stateFunc = UObject::TryCast<UFunction>(stateChild))
+					AddFunction(package, stateFunc);
+			}
+		}
+	}
+}
+
+void ScriptTranslator::AddFunction(Package* package, UStruct* func)
+{
+	UFunction* function = UObject::TryCast<UFunction>(func);
+	if (function && AllFlags(function->FuncFlags, FunctionFlags::Native))
+		return;
+
+	Bytecode* code = func->GetCode();
+	if (code->Instructions.empty())
+		return;
+
+	std::string name = CompiledScript::GetName(package, func);
+	std::string identifier = GetIdentifier(name);
+
+	std::string body;
+	body += "\tbool " + identifier + "(Frame* frame, ExpressionValue& result)\r\n";
+	body += "\t{\r\n";
+	body += "\t\tUStruct* func = frame->Func;\r\n";
+	body += "\t\tBytecode* code = func->GetCode();\r\n";
+	body += "\t\tUObject* self = frame->Object;\r\n";
+	body += "\t\tfor (int instructionsRetired = 0; instructionsRetired < 1'000'000; instructionsRetired++)\r\n";
+	body += "\t\t{\r\n";
+	body += "\t\t\tswitch (frame->StatementIndex++)\r\n";
+	body += "\t\t\t{\r\n";
+	for (size_t i = 0; i < code->Instructions.size(); i++)
+	{
+		body += "\t\t\tcase " + std::to_string(i) + ":\r\n";
+		body += WriteStatement(func, code, i);
+	}
+	body += "\t\t\tdefault:\r\n";
+	body += "\t\t\t\tFrame::ThrowException(\"Unexpected end of code statements\");\r\n";
+	body += "\t\t\t\treturn true;\r\n";
+	body += "\t\t\t}\r\n";
+	body += "\r\n";
+	body += "\t\t\tif (frame->Func != func)\r\n";
+	body += "\t\t\t\treturn false;\r\n";
+	body += "\t\t\tif (self->StateFrame.get() == frame && frame->LatentState != LatentRunState::Continue)\r\n";
+	body += "\t\t\t\treturn true;\r\n";
+	body += "\t\t}\r\n";
+	body += "\t\tFrame::ThrowException(\"Unreal script code ran for too long!\");\r\n";
+	body += "\t\treturn true;\r\n";
+	body += "\t}\r\n\r\n";
+
+	char hash[32];
+	snprintf(hash, sizeof(hash), "0x%016llxULL", (unsigned long long)code->Hash);
+
+	Functions += body;
+	Registrations += "static CompiledScriptRegistration Register_" + identifier + "(\"" + name + "\", " + hash + ", " + std::to_string(code->Instructions.size()) + ", &" + identifier + ");\r\n";
+}
+
+std::string ScriptTranslator::WriteStatement(UStruct* func, Bytecode* code, size_t index)
+{
+	const Instruction& inst = code->Instructions[index];
+	std::string operand = "code->Instructions[" + std::to_string(index) + "].Operand";
+	std::string evalOperand = "ExpressionEvaluator::Eval(" + operand + ", self, self, frame->Variables)";
+	std::string target = std::to_string(inst.Target);
+
+	std::string s;
+	switch (inst.Op)
+	{
+	case Opcode::Eval:
+		s += WriteEvalStatement(inst.Operand, operand);
+		break;
+	case Opcode::Nothing:
+	case Opcode::Case:
+		break;
+	case Opcode::Jump:
+		s += "\t\t\t\tframe->StatementIndex = " + target + ";\r\n";
+		break;
+	case Opcode::JumpIfNot:
+	{
+		TypedExpr condition = Translate(inst.Operand);
+		if (condition.Type == ExpressionValueType::ValueBool)
+			s += "\t\t\t\tif (!(" + condition.Code + "))\r\n";
+		else
+			s += "\t\t\t\tif (!" + evalOperand + ".ToBool())\r\n";
+		s += "\t\t\t\t\tframe->StatementIndex = " + target + ";\r\n";
+		break;
+	}
+	case Opcode::Switch:
+		s += "\t\t\t\tframe->ProcessSwitch(" + evalOperand + ");\r\n";
+		break;
+	case Opcode::GotoLabel:
+		s += "\t\t\t\tframe->StatementIndex = code->FindLabelIndex(" + evalOperand + ".ToName());\r\n";
+		break;
+	case Opcode::Stop:
+		s += "\t\t\t\tframe->LatentState = LatentRunState::Stop;\r\n";
+		s += "\t\t\t\treturn true;\r\n";
+		return s;
+	case Opcode::Return:
+		if (inst.Operand)
+		{
+			TypedExpr value = Translate(inst.Operand);
+			if (IsSupported(value.Type))
+				s += "\t\t\t\tresult = ExpressionValue::" + GetValueConstructor(value.Type) + "(" + value.Code + ");\r\n";
+			else
+				s += "\t\t\t\tresult = " + evalOperand + ";\r\n";
+		}
+		else if (UFunction* function = UObject::TryCast<UFunction>(func))
+		{
+			// Package 61 and earlier transfered the return value in an out parameter
+			if (function->Layout.ReturnIsParm)
+			{
+				s += "\t\t\t\tresult = ExpressionValue::PropertyValue(static_cast<UFunction*>(func)->Layout.ReturnParm);\r\n";
+				s += "\t\t\t\tresult.Load();\r\n";
+			}
+		}
+		s += "\t\t\t\treturn true;\r\n";
+		return s;
+	case Opcode::Iterator:
+		s += "\t\t\t\t" + evalOperand + ";\r\n";
+		s += "\t\t\t\tif (!Frame::CreatedIterator)\r\n";
+		s += "\t\t\t\t\tFrame::ThrowException(\"Iterator statement without an iterator!\");\r\n";
+		s += "\t\t\t\tframe->Iterators.push_back(std::move(Frame::CreatedIterator));\r\n";
+		s += "\t\t\t\tframe->Iterators.back()->StartStatementIndex = " + std::to_string(index + 1) + ";\r\n";
+		s += "\t\t\t\tframe->Iterators.back()->EndStatementIndex = " + target + ";\r\n";
+		s += "\t\t\t\tframe->StatementIndex = frame->Iterators.back()->Next() ? " + std::to_string(index + 1) + " : " + target + ";\r\n";
+		break;
+	case Opcode::IteratorNext:
+		s += "\t\t\t\tif (frame->Iterators.empty())\r\n";
+		s += "\t\t\t\t\tFrame::ThrowException(\"Iterator next statement without an iterator!\");\r\n";
+		s += "\t\t\t\tif (frame->Iterators.back()->Next())\r\n";
+		s += "\t\t\t\t\tframe->StatementIndex = frame->Iterators.back()->StartStatementIndex;\r\n";
+		s += "\t\t\t\telse\r\n";
+		s += "\t\t\t\t\tframe->StatementIndex = frame->Iterators.back()->EndStatementIndex;\r\n";
+		break;
+	case Opcode::IteratorPop:
+		s += "\t\t\t\tif (frame->Iterators.empty())\r\n";
+		s += "\t\t\t\t\tFrame::ThrowException(\"Iterator pop statement without an iterator!\");\r\n";
+		s += "\t\t\t\tframe->Iterators.pop_back();\r\n";
+		break;
+	}
+	s += "\t\t\t\tbreak;\r\n";
+	return s;
+}
+
+std::string ScriptTranslator::WriteEvalStatement(Expression* expr, const std::string& operand)
+{
+	std::string fallback = "\t\t\t\tExpressionEvaluator::Eval(" + operand + ", self, self, frame->Variables);\r\n";
+
+	Expression* leftSide = nullptr;
+	Expression* rightSide = nullptr;
+	Expression* appendValue = nullptr;
+	if (LetExpression* let = dynamic_cast<LetExpression*>(expr))
+	{
+		// The evaluator tells the actor about the assignment
+		if (let->Tracked != TrackedProperty::None)
+			return fallback;
+
+		leftSide = let->LeftSide;
+		rightSide = let->RightSide;
+		appendValue = let->AppendValue;
+	}
+	else if (LetBoolExpression* let = dynamic_cast<LetBoolExpression*>(expr))
+	{
+		leftSide = let->LeftSide;
+		rightSide = let->RightSide;
+	}
+	else
+	{
+		return fallback;
+	}
+
+	TypedExpr lvalue = TranslateVariable(leftSide);
+	if (!IsSupported(lvalue.Type))
+		return fallback;
+
+	std::string s;
+	if (appendValue)
+	{
+		TypedExpr value = Translate(appendValue);
+		if (value.Type != ExpressionValueType::ValueString)
+			return fallback;
+		s += "\t\t\t\t" + lvalue.Code + ".append(" + value.Code + ");\r\n";
+	}
+	else
+	{
+		TypedExpr rvalue = Translate(rightSide);
+		if (rvalue.Type != lvalue.Type)
+			return fallback;
+		s += "\t\t\t\t" + lvalue.Code + " = " + rvalue.Code + ";\r\n";
+	}
+
+	return s;
+}
+
+ScriptTranslator::TypedExpr ScriptTranslator::Translate(Expression* expr)
+{
+	TypedExpr result;
+	if (auto e = dynamic_cast<IntConstExpression*>(expr))
+	{
+		result.Type = ExpressionValueType::ValueInt;
+		result.Code = "(int32_t)" + std::to_string(e->Value) + "u";
+	}
+	else if (auto e = dynamic_cast<FloatConstExpression*>(expr))
+	{
+		if (!std::isfinite(e->Value))
+			return {};
+		char buffer[64];
+		snprintf(buffer, sizeof(buffer), "%af", e->Value);
+		result.Type = ExpressionValueType::ValueFloat;
+		result.Code = buffer;
+	}
+	else if (auto e = dynamic_cast<ByteConstExpression*>(expr))
+	{
+		result.Type = ExpressionValueType::ValueByte;
+		result.Code = "(uint8_t)" + std::to_string(e->Value);
+	}
+	else if (auto e = dynamic_cast<IntConstByteExpression*>(expr))
+	{
+		result.Type = ExpressionValueType::ValueByte;
+		result.Code = "(uint8_t)" + std::to_string(e->Value);
+	}
+	else if (dynamic_cast<IntZeroExpression*>(expr) || dynamic_cast<IntOneExpression*>(expr))
+	{
+		result.Type = ExpressionValueType::ValueInt;
+		result.Code = dynamic_cast<IntZeroExpression*>(expr) ? "0" : "1";
+	}
+	else if (dynamic_cast<TrueExpression*>(expr) || dynamic_cast<FalseExpression*>(expr))
+	{
+		result.Type = ExpressionValueType::ValueBool;
+		result.Code = dynamic_cast<TrueExpression*>(expr) ? "true" : "false";
+	}
+	else if (auto e = dynamic_cast<StringConstExpression*>(expr))
+	{
+		result.Type = ExpressionValueType::ValueString;
+		result.Code = "std::string(" + QuoteString(e->Value) + ")";
+	}
+	else if (auto e = dynamic_cast<SkipExpression*>(expr))
+	{
+		return Translate(e->Value);
+	}
+	else if (dynamic_cast<LocalVariableExpression*>(expr) || dynamic_cast<InstanceVariableExpression*>(expr) || dynamic_cast<BoolVariableExpression*>(expr))
+	{
+		return TranslateVariable(expr);
+	}
+	else if (dynamic_cast<NativeFunctionExpression*>(expr))
+	{
+		return TranslateNative(expr);
+	}
+	else
+	{
+		return TranslateConversion(expr);
+	}
+	return result;
+}
+
+ScriptTranslator::TypedExpr ScriptTranslator::TranslateVariable(Expression* expr)
+{
+	if (auto e = dynamic_cast<BoolVariableExpression*>(expr))
+	{
+		TypedExpr result = TranslateVariable(e->Variable);
+		return result.Type == ExpressionValueType::ValueBool ? result : TypedExpr();
+	}
+
+	UProperty* prop = nullptr;
+	std::string data;
+	if (auto e = dynamic_cast<LocalVariableExpression*>(expr))
+	{
+		prop = e->Variable;
+		data = "frame->Variables";
+	}
+	else if (auto e = dynamic_cast<InstanceVariableExpression*>(expr))
+	{
+		// The evaluator works out the timer counter as it is read
+		if (e->Tracked == TrackedProperty::TimerCounter)
+			return {};
+		prop = e->Variable;
+		data = "self->PropertyData.Data";
+	}
+
+	if (!prop || prop->ArrayDimension != 1 || !IsSupported(prop->ValueType))
+		return {};
+
+	TypedExpr result;
+	result.Type = prop->ValueType;
+	result.Code = "CompiledScriptVar<" + GetCppType(prop->ValueType) + ">(" + data + ", " + std::to_string(prop->DataOffset) + ")";
+	result.Variable = prop;
+	return result;
+}
+
+ScriptTranslator::TypedExpr ScriptTranslator::TranslateNative(Expression* expr)
+{
+	NativeFunctionExpression* e = static_cast<NativeFunctionExpression*>(expr);
+	size_t index = e->nativeindex;
+	UFunction* func = index < NativeFunctions::FuncByIndex.size() ? NativeFunctions::FuncByIndex[index] : nullptr;
+	if (!func || e->Args.size() > 2)
+		return {};
+
+	std::vector<TypedExpr> args;
+	for (Expression* arg : e->Args)
+	{
+		args.push_back(Translate(arg));
+		if (!IsSupported(args.back().Type))
+			return {};
+	}
+
+	TypedExpr result;
+	if (index < NativeFunctions::IntrinsicByIndex.size() && NativeFunctions::IntrinsicByIndex[index])
+	{
+		// All intrinsics are NObject operators taking their arguments by value
+		if (!func->StructParent || func->StructParent->Name != "Object" || !func->Layout.ReturnParm || !IsSupported(func->Layout.ReturnParm->ValueType))
+			return {};
+
+		std::vector<UProperty*> parms;
+		for (UProperty* parm : func->Layout.Parms)
+		{
+			if (parm != func->Layout.ReturnParm)
+				parms.push_back(parm);
+		}
+		if (parms.size() != args.size())
+			return {};
+
+		std::string code = "NativeIntrinsicThunk<&NObject::" + func->Name.ToString() + ">::Call(";
+		for (size_t i = 0; i < args.size(); i++)
+		{
+			if (parms[i]->ValueType != args[i].Type || AnyFlags(parms[i]->PropFlags, PropertyFlags::OutParm | PropertyFlags::OptionalParm))
+				return {};
+			if (i > 0)
+				code += ", ";
+			code += args[i].Code;
+		}
+		code += ")";
+
+		result.Type = func->Layout.ReturnParm->ValueType;
+		result.Code = code;
+	}
+	else if ((func->NativeFuncIndex == 130 || func->NativeFuncIndex == 132) && args.size() == 2 && args[0].Type == ExpressionValueType::ValueBool && args[1].Type == ExpressionValueType::ValueBool)
+	{
+		result.Type = ExpressionValueType::ValueBool;
+		result.Code = "(" + args[0].Code + (func->NativeFuncIndex == 130 ? " && " : " || ") + args[1].Code + ")";
+	}
+	return result;
+}
+
+ScriptTranslator::TypedExpr ScriptTranslator::TranslateConversion(Expression* expr)
+{
+	// Same conversions as the ExpressionEvaluator
+	ExpressionValueType from = {}, to = {};
+	Expression* value = nullptr;
+	std::string prefix, suffix;
+	auto conversion = [&](auto e, ExpressionValueType f, ExpressionValueType t, const char* p, const char* s)
+	{
+		if (!e)
+			return false;
+		value = e->Value;
+		from = f;
+		to = t;
+		prefix = p;
+		suffix = s;
+		return true;
+	};
+
+	using T = ExpressionValueType;
+	bool found =
+		conversion(dynamic_cast<ByteToIntExpression*>(expr), T::ValueByte, T::ValueInt, "(int32_t)(", ")") ||
+		conversion(dynamic_cast<ByteToBoolExpression*>(expr), T::ValueByte, T::ValueBool, "((", ") != 0)") ||
+		conversion(dynamic_cast<ByteToFloatExpression*>(expr), T::ValueByte, T::ValueFloat, "(float)(", ")") ||
+		conversion(dynamic_cast<IntToByteExpression*>(expr), T::ValueInt, T::ValueByte, "(uint8_t)(", ")") ||
+		conversion(dynamic_cast<IntToBoolExpression*>(expr), T::ValueInt, T::ValueBool, "((", ") != 0)") ||
+		conversion(dynamic_cast<IntToFloatExpression*>(expr), T::ValueInt, T::ValueFloat, "(float)(", ")") ||
+		conversion(dynamic_cast<BoolToByteExpression*>(expr), T::ValueBool, T::ValueByte, "(uint8_t)(", ")") ||
+		conversion(dynamic_cast<BoolToIntExpression*>(expr), T::ValueBool, T::ValueInt, "(int32_t)(", ")") ||
+		conversion(dynamic_cast<BoolToFloatExpression*>(expr), T::ValueBool, T::ValueFloat, "(float)(", ")") ||
+		conversion(dynamic_cast<FloatToByteExpression*>(expr), T::ValueFloat, T::ValueByte, "(uint8_t)(int32_t)(", ")") ||
+		conversion(dynamic_cast<FloatToIntExpression*>(expr), T::ValueFloat, T::ValueInt, "(int32_t)(", ")") ||
+		conversion(dynamic_cast<FloatToBoolExpression*>(expr), T::ValueFloat, T::ValueBool, "((", ") != 0.0f)");
+	if (!found)
+		return {};
+
+	TypedExpr source = Translate(value);
+	if (source.Type != from)
+		return {};
+
+	TypedExpr result;
+	result.Type = to;
+	result.Code = prefix + source.Code + suffix;
+	return result;
+}
+
+bool ScriptTranslator::IsSupported(ExpressionValueType type)
+{
+	return !GetCppType(type).empty();
+}
+
+std::string ScriptTranslator::GetCppType(ExpressionValueType type)
+{
+	switch (type)
+	{
+	case ExpressionValueType::ValueByte: return "uint8_t";
+	case ExpressionValueType::ValueInt: return "int32_t";
+	case ExpressionValueType::ValueBool: return "bool";
+	case ExpressionValueType::ValueFloat: return "float";
+	case ExpressionValueType::ValueString: return "std::string";
+	default: return {};
+	}
+}
+
+std::string ScriptTranslator::GetValueConstructor(ExpressionValueType type)
+{
+	switch (type)
+	{
+	case ExpressionValueType::ValueByte: return "ByteValue";
+	case ExpressionValueType::ValueInt: return "IntValue";
+	case ExpressionValueType::ValueBool: return "BoolValue";
+	case ExpressionValueType::ValueFloat: return "FloatValue";
+	case ExpressionValueType::ValueString: return "StringValue";
+	default: return {};
+	}
+}
+
+std::string ScriptTranslator::GetIdentifier(const std::string& name)
+{
+	std::string identifier = name;
+	for (char& c : identifier)
+	{
+		if (!std::isalnum((unsigned char)c))
+			c = '_';
+	}
+	return identifier;
+}
+
+std::string ScriptTranslator::QuoteString(const std::string& text)
+{
+	std::string quoted = "\"";
+	for (unsigned char c : text)
+	{
+		if (c >= 32 && c < 127 && c != '"' && c != '\\')
+		{
+			quoted.push_back(c);
+		}
+		else
+		{
+			char buffer[8];
+			snprintf(buffer, sizeof(buffer), "\\%03o", c);
+			quoted += buffer;
+		}
+	}
+	quoted += "\"";
+	return quoted;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+class PackageManager;
+class Package;
+class UClass;
+class UStruct;
+class UProperty;
+class Bytecode;
+class Expression;
+enum class ExpressionValueType;
+
+// Translates the bytecode of script classes to C++ registered through CompiledScript.
+// Statements that cannot be expressed natively are still evaluated by the ExpressionEvaluator from within the generated code.
+class ScriptTranslator
+{
+public:
+	// Names is a comma separated list of packages (all classes) or Package.Class entries
+	static std::string Run(PackageManager* packages, const std::string& names);
+
+private:
+	struct TypedExpr
+	{
+		ExpressionValueType Type = {};
+		std::string Code;
+		UProperty* Variable = nullptr;
+	};
+
+	void AddClass(Package* package, UClass* cls);
+	void AddFunction(Package* package, UStruct* func);
+
+	std::string WriteStatement(UStruct* func, Bytecode* code, size_t index);
+	std::string WriteEvalStatement(Expression* expr, const std::string& operand);
+
+	TypedExpr Translate(Expression* expr);
+	TypedExpr TranslateVariable(Expression* expr);
+	TypedExpr TranslateNative(Expression* expr);
+	TypedExpr TranslateConversion(Expression* expr);
+
+	static bool IsSupported(ExpressionValueType type);
+	static std::string GetCppType(ExpressionValueType type);
+	static std::string GetValueConstructor(ExpressionValueType type);
+	static std::string GetIdentifier(const std::string& name);
+	static std::string QuoteString(const std::string& text);
+
+	std::string Functions;
+	std::string Registrations;
+};
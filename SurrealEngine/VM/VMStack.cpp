@@ -0,0 +1,46 @@
+
+#include "Precomp.h"
+#include "VMStack.h"
+
+VMStack& VMStack::Get()
+{
+	thread_local VMStack stack;
+	return stack;
+}
+
+void* VMStack::Alloc(size_t size)
+{
+	size_t count = (size + 7) / 8;
+	if (count > BlockSize)
+		throw std::runtime_error("Script frame too large for the VM stack");
+
+	if (Blocks.empty())
+		Blocks.push_back(std::unique_ptr<uint64_t[]>(new uint64_t[BlockSize]));
+
+	if (CurrentOffset + count > BlockSize)
+	{
+		// Continue in the next block. Earlier blocks are left untouched so that pointers into them stay valid.
+		CurrentBlock++;
+		CurrentOffset = 0;
+		if (CurrentBlock == Blocks.size())
+			Blocks.push_back(std::unique_ptr<uint64_t[]>(new uint64_t[BlockSize]));
+	}
+
+	uint64_t* ptr = Blocks[CurrentBlock].get() + CurrentOffset;
+	CurrentOffset += count;
+	return ptr;
+}
+
+std::vector<ExpressionValue>& VMStack::PushArgs()
+{
+	if (ArgDepth == ArgLists.size())
+		ArgLists.push_back(std::make_unique<std::vector<ExpressionValue>>());
+	std::vector<ExpressionValue>& args = *ArgLists[ArgDepth++];
+	args.clear();
+	return args;
+}
+
+void VMStack::PopArgs()
+{
+	ArgLists[--ArgDepth]->clear();
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "ExpressionValue.h"
+
+// Per-thread stack arena for script call frames.
+// Frame locals are bump allocated on call and released in LIFO order on return.
+// Argument lists are recycled per call depth so their capacity is kept between calls.
+class VMStack
+{
+public:
+	struct Mark
+	{
+		size_t Block = 0;
+		size_t Offset = 0;
+	};
+
+	static VMStack& Get();
+
+	Mark GetMark() const { return { CurrentBlock, CurrentOffset }; }
+	void Release(const Mark& mark) { CurrentBlock = mark.Block; CurrentOffset = mark.Offset; }
+
+	void* Alloc(size_t size);
+
+	std::vector<ExpressionValue>& PushArgs();
+	void PopArgs();
+
+private:
+	VMStack() = default;
+
+	enum { BlockSize = 256 * 1024 / sizeof(uint64_t) }; // 256 KB, in uint64_t units
+
+	std::vector<std::unique_ptr<uint64_t[]>> Blocks;
+	size_t CurrentBlock = 0;
+	size_t CurrentOffset = 0;
+
+	std::vector<std::unique_ptr<std::vector<ExpressionValue>>> ArgLists;
+	size_t ArgDepth = 0;
+};
+
+// Borrows an argument list for the duration of a call
+class VMArgsScope
+{
+public:
+	VMArgsScope() : Args(VMStack::Get().PushArgs()) { }
+	~VMArgsScope() { VMStack::Get().PopArgs(); }
+
+	std::vector<ExpressionValue>& Args;
+
+private:
+	VMArgsScope(const VMArgsScope&) = delete;
+	VMArgsScope& operator=(const VMArgsScope&) = delete;
+};